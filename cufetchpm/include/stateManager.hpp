@@ -54,8 +54,12 @@ public:
     const toml::table& get_state() const
     { return m_state; }
 
+    // Write the index of the module prefixes of each plugin library, read by customfetch
+    void write_plugin_index();
+
 private:
     const fs::path m_path{ getConfigDir() / "plugins" / "state.toml" };
+    const fs::path m_index_path{ getConfigDir() / "plugins" / "index" };
     toml::table    m_state;
 };
 
@@ -84,6 +88,7 @@ void StateManager::insert_or_assign_at_plugin(const std::string_view repo_name,
 
         if (!writeState(ss.str(), m_path))
             die("Failed to write plugin state of repository '{}'", repo_name);
+        write_plugin_index();
         break;
     }
 }
@@ -96,6 +96,10 @@ StateManager::StateManager()
               "\t(error occurred at line {} column {})"),
             m_path.string(), err.description(), err.source().begin.line, err.source().begin.column);
     }
+
+    // plugins installed before the index existed
+    if (!fs::exists(m_index_path))
+        write_plugin_index();
 }
 
 void StateManager::add_new_repo(const CManifest& manifest)
@@ -126,6 +130,7 @@ void StateManager::add_new_repo(const CManifest& manifest)
 
     if (!writeState(ss.str(), m_path))
         die("Failed to write plugin state of repository '{}'", manifest.get_repo_name());
+    write_plugin_index();
 }
 
 std::vector<manifest_t> StateManager::get_all_repos()
@@ -186,4 +191,45 @@ void StateManager::remove_repo(const std::string& repo)
 
     if (!writeState(ss.str(), m_path))
         die("Failed to write plugin state of repository '{}'", repo);
+    write_plugin_index();
+}
+
+// customfetch reads this for loading only the plugins that have modules in the layout,
+// so it has to be cheap to parse: one line per library, its path and then its prefixes, separated by tabs
+void StateManager::write_plugin_index()
+{
+    std::string index{
+        "# AUTO-GENERATED FILE. DO NOT EDIT THIS FILE.\n"
+        "# <library path>\t<root module prefix>\t...\n"
+    };
+
+    if (const toml::table* repositories = m_state["repositories"].as_table())
+    {
+        for (const auto& [repo_name, repo_node] : *repositories)
+        {
+            const toml::table* repo_tbl = repo_node.as_table();
+            const toml::array* plugins  = repo_tbl ? repo_tbl->get_as<toml::array>("plugins") : nullptr;
+            if (!plugins)
+                continue;
+
+            for (const auto& plugin_node : *plugins)
+            {
+                const toml::table* plugin_tbl = plugin_node.as_table();
+                if (!plugin_tbl)
+                    continue;
+
+                const std::vector<std::string>& prefixes = getStrArrayValue(*plugin_tbl, "prefixes");
+                for (const std::string& library : getStrArrayValue(*plugin_tbl, "libraries"))
+                {
+                    index += library;
+                    for (const std::string& prefix : prefixes)
+                        index += '\t' + prefix;
+                    index += '\n';
+                }
+            }
+        }
+    }
+
+    if (!writeState(index, m_index_path))
+        die("Failed to write plugin index at '{}'", m_index_path.string());
 }
@@ -30,6 +30,7 @@
 #define TOML_HEADER_ONLY 0
 
 #include <filesystem>
+#include <unordered_map>
 
 #include "libcufetch/config.hh"
 
@@ -104,6 +105,13 @@ public:
     std::vector<std::string> dpkg_files;
     std::vector<std::string> apk_files;
 
+    // [cpu.usage]
+    std::uint32_t cpu_usage_sample_ms = 100;
+
+    // [live-intervals]
+    // module path -> refresh interval in ms (0 = only once)
+    std::unordered_map<std::string, std::uint32_t> live_intervals;
+
     // inner management / argument configs
     std::vector<std::string> args_layout;
     std::string              args_custom_distro;
@@ -114,6 +122,7 @@ public:
     bool                     args_disable_colors    = false;
     bool                     args_disallow_commands = false;
     bool                     args_print_logo_only   = false;
+    bool                     args_rebuild_cache     = false;
 
     /**
      * Load config file and parse every config variables
@@ -123,6 +132,23 @@ public:
      */
     void loadConfigFile(const std::filesystem::path& filename);
 
+    // What changed after reloadConfigFile()
+    enum reload_t
+    {
+        RELOAD_FAILED,     // parsing error, still using the old config
+        RELOAD_UNCHANGED,  // the same config values
+        RELOAD_LAYOUT,     // only the layout and/or [live-intervals]
+        RELOAD_ALL         // anything else
+    };
+
+    /**
+     * Load again the config file, for live mode.
+     * Unlike loadConfigFile(), it won't exit if the file can't be parsed.
+     * @param filename The config file path
+     * @return What changed in the config values
+     */
+    reload_t reloadConfigFile(const std::filesystem::path& filename);
+
     /**
      * Generate the default config file at path
      * @param filename The config file path
@@ -172,7 +198,16 @@ public:
             o.int_value  = value;
         }
         overrides[key] = std::move(o);
+        this->resolveValues();
     }
+
+private:
+    // Set the config variables from the parsed config file.
+    // When reloading, a wrong value is only a warning, the user is probably still editing the file.
+    void loadValues(const bool reloading = false);
+
+    // How many of colors_name and colors_value come from --color, the rest is from config.alias-colors
+    size_t args_alias_colors = 0;
 };
 
 #endif  // _CONFIG_HPP
@@ -28,11 +28,18 @@
 #include <pwd.h>
 #include <sys/utsname.h>
 
+#include <chrono>
+#include <string_view>
+
 #include "config.hpp"
 #include "libcufetch/cufetch.hh"
 
 #define MODFUNC(name) std::string name(__attribute__((unused)) const callbackInfo_t* callbackInfo)
 
+// Files read once for more modules (e.g /proc/stat or /sys/class/power_supply) aren't read again before this.
+// It's the minimum live mode interval, so every module of a render shares the same read.
+constexpr std::chrono::milliseconds MODULE_SNAPSHOT_TTL{ 200 };
+
 // system.cc
 MODFUNC(arch);
 MODFUNC(host);
@@ -66,6 +73,18 @@ MODFUNC(cpu_nproc);
 MODFUNC(cpu_name);
 MODFUNC(android_cpu_vendor);
 MODFUNC(android_cpu_model_name);
+inline std::uint32_t cpu_usage_first_sample_ms = 100;
+MODFUNC(cpu_usage_total);
+MODFUNC(cpu_usage_core);
+MODFUNC(cpu_usage_iowait);
+MODFUNC(cpu_usage_steal);
+
+// temp.cc
+MODFUNC(temp_sensor);
+MODFUNC(temp_core);
+MODFUNC(temp_gpu);
+MODFUNC(temp_nvme);
+MODFUNC(temp_max);
 
 // user.cc
 inline struct passwd* g_pwd;
@@ -119,7 +138,11 @@ MODFUNC(battery_status);
 MODFUNC(battery_capacity_level);
 MODFUNC(battery_technology);
 MODFUNC(battery_vendor);
-double battery_temp();
+MODFUNC(battery_cycle_count);
+MODFUNC(battery_energy_now);
+MODFUNC(battery_power_now);
+MODFUNC(battery_total_perc);
+double battery_temp(const callbackInfo_t* callbackInfo);
 
 // gpu.cc
 MODFUNC(gpu_name);
@@ -140,5 +163,19 @@ MODFUNC(theme_gsettings_font);
 MODFUNC(theme_gsettings_cursor_name);
 MODFUNC(theme_gsettings_cursor_size);
 
+// Check if a module (e.g "cpu.name") can't change its output while running
+bool is_module_static(std::string_view path);
+
+// Check if a module (e.g "user.terminal") depends on the terminal session customfetch is started from
+bool is_module_per_session(const std::string_view path);
+
+// Get the argument of a module in the path, e.g "1" from $<temp.nvme(1)> with name "nvme".
+// Empty if it has none
+std::string get_module_arg(const callbackInfo_t* callbackInfo, const std::string_view name);
+
+// Get the argument of a module as an index, e.g 1 from $<temp.nvme(1)> with module "temp.nvme".
+// 0 if it has none, dies if it's not a number.
+size_t get_module_index(const callbackInfo_t* callbackInfo, const std::string_view module);
+
 void core_plugins_start(const Config& config);
 void core_plugins_finish();
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2025 Toni500git
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _DAEMON_HPP
+#define _DAEMON_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+// customfetch --daemon keeps the modules and the rendered frame warm,
+// and serves it through a unix socket to customfetch --client.
+namespace Daemon
+{
+
+// What the client asks to the daemon
+struct request_t
+{
+    std::uint16_t         columns  = 0;
+    bool                  no_color = false;
+    std::filesystem::path config_file;
+};
+
+/*
+ * Get the path of the daemon socket.
+ * It's in $XDG_RUNTIME_DIR, or in /tmp with the user ID in its name.
+ */
+std::filesystem::path get_socket_path();
+
+/*
+ * Ask the daemon for the frame to print
+ * @param request The terminal width, colors and config file of the client
+ * @param frame The bytes to write to stdout
+ * @return false if the daemon isn't running or can't serve this request (e.g it uses another config)
+ */
+bool request_frame(const request_t& request, std::string& frame);
+
+/*
+ * Create the socket the daemon listens on.
+ * Dies if another daemon is already listening on it.
+ */
+int listen_socket(const std::filesystem::path& path);
+
+/*
+ * Accept a client connection and read its request
+ * @return The client fd, or -1 if it failed
+ */
+int accept_request(const int listen_fd, request_t& request);
+
+/*
+ * Reply to the client and close its connection
+ * @param ok false to tell the client to render it by itself
+ */
+void send_frame(const int client_fd, const bool ok, const std::string_view frame = "");
+
+/*
+ * Remove the SGR escape sequences (colors and styles) from a frame
+ */
+std::string strip_colors(const std::string_view frame);
+
+}  // namespace Daemon
+
+#endif  // _DAEMON_HPP
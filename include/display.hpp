@@ -26,6 +26,8 @@
 #ifndef _DISPLAY_HPP
 #define _DISPLAY_HPP
 
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -79,6 +81,17 @@ ${yellow}  #####${black}#######${yellow}#####
 )";
 #endif
 
+// What the terminal told us about itself, see Display::get_term_caps()
+struct term_caps_t
+{
+    // size of a cell in pixels, 0 if unknown
+    std::uint16_t cell_width  = 0;
+    std::uint16_t cell_height = 0;
+
+    bool kitty_graphics = false;
+    bool sixel          = false;
+};
+
 namespace Display
 {
 
@@ -93,9 +106,40 @@ std::vector<std::string> render(const Config& config, const bool already_analyze
 
 /*
  * Display the rendered result (or just display a normal vector of string
+ * The whole frame is written to stdout at once.
  * @param renderResult The rendered vector usually by Display::render()
+ * @param redraw_changes Only redraw the lines that changed since the previous call (used in live mode)
+ * @param clear_screen Clear the screen before drawing everything (used in live mode with wrapped lines)
+ */
+void display(const std::vector<std::string>& renderResult, const bool redraw_changes = false,
+             const bool clear_screen = false);
+
+/*
+ * Forget the previous frame, so the next display() with redraw_changes
+ * will clear the screen and draw everything again (e.g after a terminal resize)
+ */
+void reset_frame();
+
+/*
+ * Throw away the parsed logo and the rendered layout lines kept for live mode,
+ * so the next render() parses everything again (e.g after the config is reloaded)
  */
-void display(const std::vector<std::string>& renderResult);
+void reset_caches();
+
+/*
+ * Query the terminal capabilities (cell size in pixels, kitty graphics and sixel support).
+ * All the queries are sent at once and the replies are waited for a limited time,
+ * then cached for the rest of the terminal session.
+ */
+const term_caps_t& get_term_caps();
+
+/*
+ * How long the output of a module stays valid, set in [live-intervals].
+ * Static modules without an interval never change, while the others change at any time.
+ * @param module The module path without arguments (e.g "cpu.freq")
+ * @return The interval, std::chrono::milliseconds::max() if it never changes, or 0 if it can change at any time
+ */
+std::chrono::milliseconds get_module_interval(const Config& config, const std::string_view module);
 
 /*
  * Detect the distro you are using and return the path to the ASCII art
@@ -114,6 +158,12 @@ inline unsigned int calc_perc(const float perc, const int width, const int len)
 // default ascii logo fd
 inline int ascii_logo_fd = -1;
 
+// escape sequences written along with the next frame (e.g hiding the cursor)
+inline std::string frame_prefix;
+
+// terminal width to render for, instead of the one of stdout, if not 0 (used in daemon mode)
+inline std::uint16_t columns = 0;
+
 }  // namespace Display
 
 #endif
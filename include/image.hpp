@@ -0,0 +1,54 @@
+/*
+ * Copyright 2025 Toni500git
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _IMAGE_HPP
+#define _IMAGE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace Image
+{
+
+/*
+ * Get the escape sequences for displaying an image in the terminal with a graphics protocol,
+ * at the cursor position, which is left unchanged.
+ * The image is decoded and encoded only once, and later calls return the cached payload.
+ * With kitty, the image is transmitted only the first time, and then placed again by its ID.
+ * @param path Path to the image
+ * @param protocol "kitty", "sixel" or "iterm2"
+ * @param cols Width of the image in terminal cells
+ * @param rows Height of the image in terminal cells
+ * @param cell_width Width of a cell in pixels
+ * @param cell_height Height of a cell in pixels
+ */
+std::string encode(const std::filesystem::path& path, const std::string_view protocol, const std::uint16_t cols,
+                   const std::uint16_t rows, const std::uint16_t cell_width, const std::uint16_t cell_height);
+
+}  // namespace Image
+
+#endif  // _IMAGE_HPP
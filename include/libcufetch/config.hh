@@ -25,8 +25,11 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <variant>
+#include <vector>
 
 #define TOML_HEADER_ONLY 0
 #include "libcufetch/common.hh"
@@ -47,9 +50,84 @@ struct override_configs_types
     int         int_value    = 0;
 };
 
+/**
+ * Handle to a config value registered with one of ConfigBase::registerValue*().
+ * Reading it with ConfigBase::get() is an index into an array,
+ * instead of looking up the overrides and walking the toml tree each time.
+ */
+template <typename T>
+struct config_handle_t
+{
+    size_t index = static_cast<size_t>(-1);
+};
+
 class EXPORT ConfigBase
 {
 public:
+    // Forgets the config variables registered in it
+    ~ConfigBase();
+
+    /**
+     * Register a string config variable, resolved now and every time the config is (re)loaded
+     * @param value The config variable "path" (e.g "config.sep-reset")
+     * @param fallback Default value if couldn't retrive value
+     */
+    config_handle_t<std::string> registerValueStr(const std::string_view value, const std::string& fallback) const
+    {
+        return registerValue<std::string>(value, fallback);
+    }
+
+    /**
+     * Register an integer config variable, resolved now and every time the config is (re)loaded
+     * @param value The config variable "path" (e.g "config.offset")
+     * @param fallback Default value if couldn't retrive value
+     */
+    config_handle_t<int> registerValueInt(const std::string_view value, const int fallback) const
+    {
+        return registerValue<int>(value, fallback);
+    }
+
+    /**
+     * Register a boolean config variable, resolved now and every time the config is (re)loaded
+     * @param value The config variable "path" (e.g "config.wrap-lines")
+     * @param fallback Default value if couldn't retrive value
+     */
+    config_handle_t<bool> registerValueBool(const std::string_view value, const bool fallback) const
+    {
+        return registerValue<bool>(value, fallback);
+    }
+
+    /**
+     * Register an array string config variable, resolved now and every time the config is (re)loaded
+     * @param value The config variable "path" (e.g "config.percentage-colors")
+     * @param fallback Default value if couldn't retrive value
+     */
+    config_handle_t<std::vector<std::string>> registerValueArrayStr(const std::string_view          value,
+                                                                    const std::vector<std::string>& fallback) const
+    {
+        return registerValue<std::vector<std::string>>(value, fallback);
+    }
+
+    // Value of a registered config variable, of the same type of its fallback
+    using config_value_t = std::variant<bool, int, std::string, std::vector<std::string>>;
+
+    /**
+     * Get the value of a registered config variable.
+     * The reference stays valid as long as the config.
+     * @param handle The handle returned by registerValue*()
+     */
+    template <typename T>
+    const T& get(const config_handle_t<T> handle) const
+    {
+        return std::get<T>(getRegistered(handle.index));
+    }
+
+    /**
+     * Get how many times the registered config variables were resolved again (e.g config reloaded in live mode).
+     * Useful for knowing when to throw away what was computed from them.
+     */
+    std::uint32_t getGeneration() const;
+
     /**
      * Get array string value of a config variable
      * @param value The config variable "path" (e.g "config.layout")
@@ -107,6 +185,30 @@ public:
     }
 
 private:
+    template <typename T>
+    config_handle_t<T> registerValue(const std::string_view value, const T& fallback) const
+    {
+        return { registerValue(value, config_value_t(fallback)) };
+    }
+
+    // The registered config variables are kept in libcufetch (parse.cc) by the address of the config
+    // until it's destroyed, so this class keeps the same layout for the plugins built against an older libcufetch.
+    size_t                registerValue(const std::string_view value, const config_value_t& fallback) const;
+    const config_value_t& getRegistered(const size_t index) const;
+
+    config_value_t resolveValue(const std::string_view value, const config_value_t& fallback) const
+    {
+        return std::visit(
+            [&](const auto& def) -> config_value_t {
+                using T = std::decay_t<decltype(def)>;
+                if constexpr (std::is_same_v<T, std::vector<std::string>>)
+                    return getValueArrayStr(value, def);
+                else
+                    return getValue<T>(value, def);
+            },
+            fallback);
+    }
+
     /**
      * Get value of a config variables
      * @param value The config variable "path" (e.g "config.source-path")
@@ -135,6 +237,12 @@ private:
     }
 
 protected:
+    /**
+     * Resolve again all the registered config variables.
+     * To be called after the config is loaded or overridden.
+     */
+    void resolveValues();
+
     std::unordered_map<std::string, override_configs_types> overrides;
 
     // Parsed config from loadConfigFile()
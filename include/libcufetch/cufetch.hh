@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <vector>
@@ -79,6 +80,16 @@ struct module_t
     std::function<std::string(const callbackInfo_t*)> handler;
 };
 
+/* Statistics about the calls to a module handler, see cfEnableModuleStats() */
+struct module_stats_t
+{
+    std::string   name;          /* Full path of the module (e.g "cpu.name") */
+    std::uint64_t calls    = 0;
+    std::uint64_t total_ns = 0;  /* Time spent in the handler, in nanoseconds */
+    std::uint64_t max_ns   = 0;  /* Time spent in the slowest call, in nanoseconds */
+    std::uint64_t bytes    = 0;  /* Total length of the strings returned */
+};
+
 // C ABI is needed to prevent symbol mangling, but we don't actually need C compatibility,
 // so we ignore this warning about return types that are potentially incompatible with C.
 #ifdef __clang__
@@ -91,3 +102,10 @@ APICALL EXPORT void cfRegisterModule(const module_t& module);
 
 /* Get a list of all modules registered. */
 APICALL EXPORT const std::vector<module_t>& cfGetModules();
+
+/* Start or stop collecting statistics about the module handlers calls.
+ * It's disabled by default, since it measures the time of each call. */
+APICALL EXPORT void cfEnableModuleStats(const bool enable);
+
+/* Get the statistics of the modules called since cfEnableModuleStats(true), sorted by total time spent. */
+APICALL EXPORT std::vector<module_stats_t> cfGetModuleStats();
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2025 Toni500git
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _PROFILE_HPP
+#define _PROFILE_HPP
+
+#include <chrono>
+#include <filesystem>
+#include <string_view>
+
+#include "libcufetch/common.hh"
+
+// Startup profiler, enabled with --profile.
+// It records the time spent in each phase and module handler, and counts cache hits and process spawns.
+// When disabled, every function here returns right away.
+namespace Profile
+{
+
+using time_point_t = std::chrono::steady_clock::time_point;
+
+EXPORT extern bool enabled;
+
+/*
+ * Start recording, and write the report at exit.
+ * @param output Path to the file where to write the report, in the Chrome trace event format
+ */
+EXPORT void enable(const std::filesystem::path& output);
+
+/*
+ * Record a complete event
+ * @param category Category of the event (e.g "phase", "module", "plugin")
+ * @param name Name of the event
+ */
+EXPORT void add_span(const std::string_view category, const std::string_view name, const time_point_t start,
+                     const time_point_t end);
+
+/*
+ * Increase a counter by 1 (e.g "cache_hit.config")
+ */
+EXPORT void count(const std::string_view counter);
+
+/*
+ * Record a process being spawned.
+ * Weak because util.cpp is also linked in cufetchpm, without libcufetch.
+ * @param command The command that is executed
+ */
+EXPORT __attribute__((weak)) void record_spawn(const std::string_view command);
+
+/*
+ * Write the report to the path given to enable().
+ * It's already called at exit.
+ */
+EXPORT void write();
+
+// Records the time from its construction until it goes out of scope, or end() is called.
+// category and name must outlive the span.
+class Span
+{
+public:
+    Span(const std::string_view category, const std::string_view name) : m_category(category), m_name(name)
+    {
+        if (enabled)
+            m_start = std::chrono::steady_clock::now();
+    }
+
+    ~Span()
+    { end(); }
+
+    void end()
+    {
+        if (!enabled || m_ended)
+            return;
+
+        m_ended = true;
+        add_span(m_category, m_name, m_start, std::chrono::steady_clock::now());
+    }
+
+private:
+    std::string_view m_category;
+    std::string_view m_name;
+    time_point_t     m_start;
+    bool             m_ended = false;
+};
+
+}  // namespace Profile
+
+#endif  // _PROFILE_HPP
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2025 Toni500git
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _SNAPSHOT_HPP
+#define _SNAPSHOT_HPP
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "libcufetch/common.hh"
+
+// Snapshot of the modules output, saved with --snapshot and then used by the next runs,
+// so only the modules expired or that can change at any time are evaluated again.
+namespace Snapshot
+{
+
+// How long the output of a module (path without arguments) stays valid.
+// std::chrono::milliseconds::max() if it never changes, and 0 if it can't be saved.
+using lifetime_func_t = std::function<std::chrono::milliseconds(const std::string_view module)>;
+
+EXPORT extern bool enabled;
+
+/*
+ * Load the snapshot, and start using and updating it
+ * @param path Path to the snapshot file
+ * @param key Everything the modules output depends on (boot ID, config, plugins).
+ *            The snapshot is thrown away if it was saved with another key.
+ * @param lifetime Function for getting how long the output of a module stays valid
+ * @param refresh Don't use the saved values, but evaluate everything again
+ */
+EXPORT void load(const std::filesystem::path& path, const std::string& key, const lifetime_func_t& lifetime,
+                 const bool refresh);
+
+/*
+ * Get the saved output of a module, if it's not expired
+ * @param module The module as written in the layout, with its arguments (e.g "disk(/).used")
+ */
+EXPORT bool get(const std::string& module, std::string& value);
+
+/*
+ * Save the output of a module, if it can be saved
+ * @param module The module as written in the layout, with its arguments (e.g "disk(/).used")
+ * @param path The module path without arguments (e.g "disk.used")
+ */
+EXPORT void put(const std::string& module, const std::string_view path, const std::string& value);
+
+/*
+ * Write the snapshot file, if something changed since load()
+ */
+EXPORT void save();
+
+}  // namespace Snapshot
+
+#endif  // _SNAPSHOT_HPP
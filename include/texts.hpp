@@ -128,7 +128,8 @@ LAYOUT & FORMATTING:
 
 GUI/TERMINAL OPTIONS:
     -f, --font <STRING>         GUI font (format: "FAMILY STYLE SIZE", e.g., "Liberation Mono Normal 12").
-    -i, --image-backend <NAME>  Terminal image backend ("kitty" or "viu").
+    -i, --image-backend <NAME>  Terminal image backend ("kitty", "sixel", "iterm2" or "viu").
+                                By default the best protocol supported by the terminal is used.
     --bg-image <PATH>           GUI background image path ("disable" to turn off).
 
 CONFIG:
@@ -142,14 +143,30 @@ CONFIG:
     --disallow-command-tag      Do not allow command tags $() to be executed.
                                 This is a safety measure for preventing malicious code to be executed because you didn't want to check the config first.
 
+    --rebuild-cache             Parse the config file again instead of using its cached binary image.
+
+    --snapshot=[<BOOL>]         Save the output of the modules in ~/.cache/customfetch/, then the next runs with the same config
+                                evaluate again only the modules expired (see [live-intervals]) or that can always change.
+                                --snapshot=false removes it, and the next runs evaluate everything again.
+
 INFORMATIONAL:
     -l, --list-modules          List all available info tag modules (e.g., $<cpu> or $<os.name>).
     -w, --how-it-works          Explain tags and general customization.
     --list-logos                List available ASCII logos in --data-dir.
+    --profile=[<PATH>]          Write the time spent in each phase and module to <PATH>, in the Chrome trace format
+                                (default: ~/.cache/customfetch/profile.json). Open it in chrome://tracing or Perfetto.
 
 LIVE MODE:
     --loop-ms <NUM>             Run in live mode, updating every <NUM> milliseconds (min: 50).
                                 Use inferior <NUM> than 200 to disable. Press 'q' to exit.
+                                Press 's' to show how many times each module is called and how long it takes.
+
+DAEMON MODE:
+    --daemon                    Keep running and serve the rendered output through a unix socket
+                                ($XDG_RUNTIME_DIR/customfetch.sock), refreshed every --loop-ms (default: 1000).
+    --client                    Print the output rendered by the daemon, or render it normally if it isn't running.
+                                Only -C and -N can be used along with it.
+                                The config file and the logo are reloaded when modified.
 
 EXAMPLES:
     1. Minimal output with default logo:
@@ -452,6 +469,28 @@ dpkg-files   = ["/var/lib/dpkg/status", "/data/data/com.termux/files/usr/var/lib
 flatpak-dirs = ["/var/lib/flatpak/app/", "~/.local/share/flatpak/app/"]
 apk-files    = ["/var/lib/apk/db/installed"]
 
+# How often (in milliseconds) each module is refreshed in live mode (--loop-ms).
+# A layout line is parsed again only when one of its modules is due,
+# else its previous output is reused.
+# Static modules (e.g $<os.name>, $<cpu.name>, $<user>) are computed only once,
+# other modules not listed here (and lines with commands) are refreshed at every tick.
+# A module path also applies to its submodules (e.g "cpu.freq" -> $<cpu.freq.max>).
+# 0 = compute it only once.
+[live-intervals]
+"os.uptime" = 1000
+"cpu.freq"  = 1000
+"ram"       = 2000
+"swap"      = 2000
+"disk"      = 30000
+"os.pkgs"   = 0
+
+# $<cpu.usage> config
+[cpu.usage]
+# The CPU usage is calculated between two samples of /proc/stat.
+# In live mode the previous frame sample is used, but on the first run
+# we have to wait this amount of milliseconds before taking the second one.
+sample-ms = 100
+
 # Desktop/Android app options
 [gui]
 
@@ -108,6 +108,12 @@ EXPORT bool hasStart(const std::string_view fullString, const std::string_view s
  */
 EXPORT std::vector<std::string> split(const std::string_view text, const char delim);
 
+/* Get how many terminal cells an UTF-8 string (without escape sequences) takes.
+ * Wide characters (e.g CJK and emojis) take 2 cells, combining characters none.
+ * @param str The string to measure
+ */
+EXPORT size_t get_display_width(const std::string_view str);
+
 /* Get device name from `all_ids` in pci.ids.hpp
  * @param dev_entry_pos Line position from where the device is located
  */
@@ -29,18 +29,24 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
+#include <deque>
 #include <ios>
 #include <optional>
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include "fmt/format.h"
 #include "libcufetch/common.hh"
 #include "libcufetch/config.hh"
 #include "libcufetch/cufetch.hh"
+#include "profile.hpp"
+#include "snapshot.hpp"
 #include "switch_fnv1a.hpp"
 #include "tiny-process-library/process.hpp"
 #include "util.hpp"
@@ -92,6 +98,142 @@ public:
 // pure_output
 std::string _;
 
+// Registered config variables of a config, only a cache of its toml table and overrides.
+// A deque, so the references returned by ConfigBase::get() aren't invalidated by new registrations.
+struct config_registry_t
+{
+    struct value_t
+    {
+        std::string                path;
+        ConfigBase::config_value_t fallback;
+        ConfigBase::config_value_t value;
+    };
+
+    std::deque<value_t> values;
+    std::uint32_t       generation = 0;
+};
+
+// By the address of the config, erased by ~ConfigBase() so a new config at the same address starts empty
+static std::unordered_map<const ConfigBase*, config_registry_t> config_registries;
+
+// there's usually a single config, don't hash its address on every get()
+static const ConfigBase*  last_config   = nullptr;
+static config_registry_t* last_registry = nullptr;
+
+// the config which the handles of get_parse_config() were registered in
+static const ConfigBase* parse_config_owner = nullptr;
+
+static config_registry_t& get_config_registry(const ConfigBase& config)
+{
+    if (last_config != &config)
+    {
+        last_config   = &config;
+        last_registry = &config_registries[&config];
+    }
+
+    return *last_registry;
+}
+
+ConfigBase::~ConfigBase()
+{
+    config_registries.erase(this);
+    if (last_config == this)
+    {
+        last_config   = nullptr;
+        last_registry = nullptr;
+    }
+    if (parse_config_owner == this)
+        parse_config_owner = nullptr;
+}
+
+size_t ConfigBase::registerValue(const std::string_view value, const config_value_t& fallback) const
+{
+    config_registry_t& registry = get_config_registry(*this);
+    for (size_t i = 0; i < registry.values.size(); ++i)
+        if (registry.values[i].path == value && registry.values[i].fallback.index() == fallback.index())
+            return i;
+
+    registry.values.push_back({ std::string(value), fallback, resolveValue(value, fallback) });
+    return registry.values.size() - 1;
+}
+
+const ConfigBase::config_value_t& ConfigBase::getRegistered(const size_t index) const
+{
+    const config_registry_t& registry = get_config_registry(*this);
+    if (index >= registry.values.size())
+        die(_("Config value handle {} isn't registered in this config"), index);
+
+    return registry.values[index].value;
+}
+
+std::uint32_t ConfigBase::getGeneration() const
+{ return get_config_registry(*this).generation; }
+
+void ConfigBase::resolveValues()
+{
+    config_registry_t& registry = get_config_registry(*this);
+    for (config_registry_t::value_t& reg : registry.values)
+        reg.value = resolveValue(reg.path, reg.fallback);
+    ++registry.generation;
+}
+
+// Config values read on every tag,
+// registered once so reading them doesn't look up the overrides and walk the toml tree
+struct parse_config_t
+{
+    config_handle_t<bool>                     disable_colors;
+    config_handle_t<bool>                     disallow_commands;
+    config_handle_t<bool>                     sep_reset_after;
+    config_handle_t<std::string>              sep_reset;
+    config_handle_t<std::vector<std::string>> percentage_colors;
+    config_handle_t<std::vector<std::string>> alias_colors;
+
+    // black, red, green, yellow, blue, magenta, cyan, white
+    std::array<config_handle_t<std::string>, 8> colors;
+    std::array<config_handle_t<std::string>, 8> gui_colors;
+};
+
+static const parse_config_t& get_parse_config(const ConfigBase& config)
+{
+    static parse_config_t handles;
+    if (parse_config_owner == &config)
+        return handles;
+
+    // clang-format off
+    handles.disable_colors    = config.registerValueBool("intern.args.disable-colors", false);
+    handles.disallow_commands = config.registerValueBool("intern.args.disallow-commands", false);
+    handles.sep_reset_after   = config.registerValueBool("config.sep-reset-after", false);
+    handles.sep_reset         = config.registerValueStr("config.sep-reset", ":");
+    handles.percentage_colors = config.registerValueArrayStr("config.percentage-colors", { "green", "yellow", "red" });
+    handles.alias_colors      = config.registerValueArrayStr("config.alias-colors", {});
+
+    handles.colors = {
+        config.registerValueStr("config.black",   "\033[1;30m"),
+        config.registerValueStr("config.red",     "\033[1;31m"),
+        config.registerValueStr("config.green",   "\033[1;32m"),
+        config.registerValueStr("config.yellow",  "\033[1;33m"),
+        config.registerValueStr("config.blue",    "\033[1;34m"),
+        config.registerValueStr("config.magenta", "\033[1;35m"),
+        config.registerValueStr("config.cyan",    "\033[1;36m"),
+        config.registerValueStr("config.white",   "\033[1;37m")
+    };
+
+    handles.gui_colors = {
+        config.registerValueStr("gui.black",   "!#000005"),
+        config.registerValueStr("gui.red",     "!#ff2000"),
+        config.registerValueStr("gui.green",   "!#00ff00"),
+        config.registerValueStr("gui.yellow",  "!#ffff00"),
+        config.registerValueStr("gui.blue",    "!#00aaff"),
+        config.registerValueStr("gui.magenta", "!#ff11cc"),
+        config.registerValueStr("gui.cyan",    "!#00ffff"),
+        config.registerValueStr("gui.white",   "!#ffffff")
+    };
+    // clang-format on
+
+    parse_config_owner = &config;
+    return handles;
+}
+
 #if GUI_APP
 // Get span tags from an ANSI escape color such as \e[0;31m
 // @param noesc_str The ansi color without \\e[ or \033[
@@ -123,14 +265,9 @@ static std::array<std::string, 3> get_ansi_color(const std::string_view noesc_st
     // clang-format off
     switch (col.back())
     {
-        case '0': col = config.getValueStr("gui.black",   "!#000005"); break;
-        case '1': col = config.getValueStr("gui.red",     "!#ff2000"); break;
-        case '2': col = config.getValueStr("gui.green",   "!#00ff00"); break;
-        case '3': col = config.getValueStr("gui.yellow",  "!#ffff00"); break;
-        case '4': col = config.getValueStr("gui.blue",    "!#00aaff"); break;
-        case '5': col = config.getValueStr("gui.magenta", "!#ff11cc"); break;
-        case '6': col = config.getValueStr("gui.cyan",    "!#00ffff"); break;
-        case '7': col = config.getValueStr("gui.white",   "!#ffffff"); break;
+        case '0': case '1': case '2': case '3':
+        case '4': case '5': case '6': case '7':
+            col = config.get(get_parse_config(config).gui_colors[col.back() - '0']); break;
     }
 
     if (col.at(0) != '#')
@@ -191,7 +328,7 @@ EXPORT std::string parse(const std::string& input, std::string& _, parse_args_t&
 EXPORT std::string get_and_color_percentage(const float n1, const float n2, parse_args_t& parse_args, const bool invert)
 {
     const std::vector<std::string>& percentage_colors =
-        parse_args.config.getValueArrayStr("config.percentage-colors", { "green", "yellow", "red" });
+        parse_args.config.get(get_parse_config(parse_args.config).percentage_colors);
     const float result = n1 / n2 * static_cast<float>(100);
 
     std::string color;
@@ -318,8 +455,53 @@ static std::string parse(Parser& p, moduleArgs_t* m, bool collecting, char until
     return token;
 }
 
+static bool                                            module_stats_enabled = false;
+static std::unordered_map<std::string, module_stats_t> module_stats;
+
+APICALL EXPORT void cfEnableModuleStats(const bool enable)
+{ module_stats_enabled = enable; }
+
+APICALL EXPORT std::vector<module_stats_t> cfGetModuleStats()
+{
+    std::vector<module_stats_t> ret;
+    ret.reserve(module_stats.size());
+    for (const auto& [_, stats] : module_stats)
+        ret.push_back(stats);
+
+    std::sort(ret.begin(), ret.end(),
+              [](const module_stats_t& a, const module_stats_t& b) { return a.total_ns > b.total_ns; });
+    return ret;
+}
+
+static std::string call_module_handler(const std::string& name, const module_t& module,
+                                       const callbackInfo_t* callbackInfo)
+{
+    Profile::Span span("module", name);
+    if (!module_stats_enabled)
+        return module.handler(callbackInfo);
+
+    const auto&         start  = std::chrono::steady_clock::now();
+    std::string         result = module.handler(callbackInfo);
+    const std::uint64_t ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    module_stats_t& stats = module_stats[name];
+    if (stats.name.empty())
+        stats.name = name;
+    ++stats.calls;
+    stats.total_ns += ns;
+    stats.max_ns = std::max(stats.max_ns, ns);
+    stats.bytes += result.length();
+
+    return result;
+}
+
 std::string getInfoFromName(parse_args_t& parse_args, const std::string& moduleName)
 {
+    std::string result;
+    if (Snapshot::enabled && Snapshot::get(moduleName, result))
+        return result;
+
     Parser        parser(moduleName, _);
     moduleArgs_t* moduleArgs = new moduleArgs_t;
     parse(parser, moduleArgs);
@@ -337,12 +519,17 @@ std::string getInfoFromName(parse_args_t& parse_args, const std::string& moduleN
     name.pop_back();
     debug("name = {}", name);
 
-    std::string result = "(unknown/invalid module)";
+    result = "(unknown/invalid module)";
     if (const auto& it = parse_args.modules_info.find(name); it != parse_args.modules_info.end())
     {
         struct callbackInfo_t callbackInfo = { moduleArgs, parse_args };
 
-        result = it->second.handler(&callbackInfo);
+        const size_t tmp_layout_size = parse_args.tmp_layout.size();
+        result = call_module_handler(it->first, it->second, &callbackInfo);
+
+        // modules that add layout lines (e.g $<auto.disk>) don't only return their output
+        if (Snapshot::enabled && parse_args.tmp_layout.size() == tmp_layout_size)
+            Snapshot::put(moduleName, name, result);
     }
 
     while (moduleArgs)
@@ -385,13 +572,14 @@ std::optional<std::string> parse_command_tag(Parser& parser, parse_args_t& parse
     if (!evaluate)
         return {};
 
-    if (parse_args.config.getValueBool("intern.args.disallow-commands", false))
+    if (parse_args.config.get(get_parse_config(parse_args.config).disallow_commands))
         die(_("Trying to execute command $({}) but --disallow-command-tag is set"), command);
 
     const bool removetag = (command.front() == '!');
     if (removetag)
         command.erase(0, 1);
 
+    Profile::record_spawn(command);
     std::string             cmd_output;
     TinyProcessLib::Process proc(command, "", [&](const char* bytes, size_t n) { cmd_output.assign(bytes, n); });
     if (!parse_args.parsing_layout && !removetag && parser.dollar_pos != std::string::npos)
@@ -420,10 +608,11 @@ std::optional<std::string> parse_color_tag(Parser& parser, parse_args_t& parse_a
 
     std::string       output;
     const size_t      taglen  = color.length() + "${}"_len;
-    const ConfigBase& config  = parse_args.config;
-    const std::string endspan = !parse_args.firstrun_clr ? "</span>" : "";
+    const ConfigBase&     config  = parse_args.config;
+    const parse_config_t& handles = get_parse_config(config);
+    const std::string     endspan = !parse_args.firstrun_clr ? "</span>" : "";
 
-    if (config.getValueBool("intern.args.disable-colors", false))
+    if (config.get(handles.disable_colors))
     {
         if (parser.dollar_pos != std::string::npos)
             parse_args.pure_output.erase(parser.dollar_pos, taglen);
@@ -437,28 +626,33 @@ std::optional<std::string> parse_color_tag(Parser& parser, parse_args_t& parse_a
         output += ' ';
 #endif
 
+    // built again when the config is reloaded
     static std::vector<std::string> alias_colors_name, alias_colors_value;
-    const std::vector<std::string>& alias_colors = config.getValueArrayStr("config.alias-colors", {});
-    if (!alias_colors.empty() && (alias_colors_name.empty() && alias_colors_value.empty()))
+    static std::uint32_t            alias_colors_generation = -1;
+    const std::vector<std::string>& alias_colors = config.get(handles.alias_colors);
+    if (alias_colors_generation != config.getGeneration())
     {
+        alias_colors_generation = config.getGeneration();
+        alias_colors_name.clear();
+        alias_colors_value.clear();
+
         for (const std::string& str : alias_colors)
         {
+            // Config::loadValues() already reported it (and exited if it's not a live reload)
             const size_t pos = str.find('=');
             if (pos == std::string::npos)
-                die(_("alias color '{}' does NOT have an equal sign '=' for separating color name and value\n"
-                      "For more check with --help"),
-                    str);
+                continue;
 
             alias_colors_name.push_back(str.substr(0, pos));
             alias_colors_value.push_back(str.substr(pos + 1));
         }
+    }
 
-        const auto& it_name = std::find(alias_colors_name.begin(), alias_colors_name.end(), color);
-        if (it_name != alias_colors_name.end())
-        {
-            const size_t index = std::distance(alias_colors_name.begin(), it_name);
-            color              = alias_colors_value.at(index);
-        }
+    const auto& it_name = std::find(alias_colors_name.begin(), alias_colors_name.end(), color);
+    if (it_name != alias_colors_name.end())
+    {
+        const size_t index = std::distance(alias_colors_name.begin(), it_name);
+        color              = alias_colors_value.at(index);
     }
 
     static std::vector<std::string> auto_colors;
@@ -500,14 +694,14 @@ std::optional<std::string> parse_color_tag(Parser& parser, parse_args_t& parse_a
 #if GUI_APP
         switch (fnv1a16::hash(color))
         {
-            case "black"_fnv1a16:   str_clr = config.getValueStr("gui.black",   "!#000005"); break;
-            case "red"_fnv1a16:     str_clr = config.getValueStr("gui.red",     "!#ff2000"); break;
-            case "green"_fnv1a16:   str_clr = config.getValueStr("gui.green",   "!#00ff00"); break;
-            case "yellow"_fnv1a16:  str_clr = config.getValueStr("gui.yellow",  "!#ffff00"); break;
-            case "blue"_fnv1a16:    str_clr = config.getValueStr("gui.blue",    "!#00aaff"); break;
-            case "magenta"_fnv1a16: str_clr = config.getValueStr("gui.magenta", "!#ff11cc"); break;
-            case "cyan"_fnv1a16:    str_clr = config.getValueStr("gui.cyan",    "!#00ffff"); break;
-            case "white"_fnv1a16:   str_clr = config.getValueStr("gui.white",   "!#ffffff"); break;
+            case "black"_fnv1a16:   str_clr = config.get(handles.gui_colors[0]); break;
+            case "red"_fnv1a16:     str_clr = config.get(handles.gui_colors[1]); break;
+            case "green"_fnv1a16:   str_clr = config.get(handles.gui_colors[2]); break;
+            case "yellow"_fnv1a16:  str_clr = config.get(handles.gui_colors[3]); break;
+            case "blue"_fnv1a16:    str_clr = config.get(handles.gui_colors[4]); break;
+            case "magenta"_fnv1a16: str_clr = config.get(handles.gui_colors[5]); break;
+            case "cyan"_fnv1a16:    str_clr = config.get(handles.gui_colors[6]); break;
+            case "white"_fnv1a16:   str_clr = config.get(handles.gui_colors[7]); break;
             default:                str_clr = color; break;
         }
 
@@ -635,14 +829,14 @@ std::optional<std::string> parse_color_tag(Parser& parser, parse_args_t& parse_a
 #else
         switch (fnv1a16::hash(color))
         {
-            case "black"_fnv1a16:   str_clr = config.getValueStr("config.black",   "\033[1;30m"); break;
-            case "red"_fnv1a16:     str_clr = config.getValueStr("config.red",     "\033[1;31m"); break;
-            case "green"_fnv1a16:   str_clr = config.getValueStr("config.green",   "\033[1;32m"); break;
-            case "yellow"_fnv1a16:  str_clr = config.getValueStr("config.yellow",  "\033[1;33m"); break;
-            case "blue"_fnv1a16:    str_clr = config.getValueStr("config.blue",    "\033[1;34m"); break;
-            case "magenta"_fnv1a16: str_clr = config.getValueStr("config.magenta", "\033[1;35m"); break;
-            case "cyan"_fnv1a16:    str_clr = config.getValueStr("config.cyan",    "\033[1;36m"); break;
-            case "white"_fnv1a16:   str_clr = config.getValueStr("config.white",   "\033[1;37m"); break;
+            case "black"_fnv1a16:   str_clr = config.get(handles.colors[0]); break;
+            case "red"_fnv1a16:     str_clr = config.get(handles.colors[1]); break;
+            case "green"_fnv1a16:   str_clr = config.get(handles.colors[2]); break;
+            case "yellow"_fnv1a16:  str_clr = config.get(handles.colors[3]); break;
+            case "blue"_fnv1a16:    str_clr = config.get(handles.colors[4]); break;
+            case "magenta"_fnv1a16: str_clr = config.get(handles.colors[5]); break;
+            case "cyan"_fnv1a16:    str_clr = config.get(handles.colors[6]); break;
+            case "white"_fnv1a16:   str_clr = config.get(handles.colors[7]); break;
             default:                str_clr = color; break;
         }
 
@@ -835,10 +1029,11 @@ std::string parse(Parser& parser, parse_args_t& parse_args, const bool evaluate,
 
 EXPORT std::string parse(std::string input, parse_args_t& parse_args)
 {
-    static const std::string& sep_reset = parse_args.config.getValueStr("config.sep-reset", ":");
+    const parse_config_t& handles   = get_parse_config(parse_args.config);
+    const std::string&    sep_reset = parse_args.config.get(handles.sep_reset);
     if (!sep_reset.empty() && parse_args.parsing_layout && !parse_args.no_more_reset)
     {
-        if (parse_args.config.getValueBool("config.sep-reset-after", false))
+        if (parse_args.config.get(handles.sep_reset_after))
             replace_str(input, sep_reset, sep_reset + "${0}");
         else
             replace_str(input, sep_reset, "${0}" + sep_reset);
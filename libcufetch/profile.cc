@@ -0,0 +1,161 @@
+/*
+ * Copyright 2025 Toni500git
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "profile.hpp"
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fmt/format.h"
+#include "util.hpp"
+
+namespace Profile
+{
+
+bool enabled = false;
+
+struct event_t
+{
+    std::string  category;
+    std::string  name;
+    char         phase;  // 'X' for complete events, 'i' for instant events
+    std::int64_t ts;     // microseconds since the start
+    std::int64_t dur;
+};
+
+// libcufetch is loaded before main(), so this is close enough to the process start
+static const time_point_t                               start_time = std::chrono::steady_clock::now();
+static std::filesystem::path                            output_path;
+static std::vector<event_t>                             events;
+static std::map<std::string, std::uint64_t, std::less<>> counters;
+
+static std::int64_t to_us(const time_point_t tp)
+{ return std::chrono::duration_cast<std::chrono::microseconds>(tp - start_time).count(); }
+
+static std::string json_escape(const std::string_view str)
+{
+    std::string ret;
+    ret.reserve(str.length());
+    for (const char c : str)
+    {
+        switch (c)
+        {
+            case '"':  ret += "\\\""; break;
+            case '\\': ret += "\\\\"; break;
+            case '\n': ret += "\\n"; break;
+            case '\t': ret += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                    ret += fmt::format("\\u{:04x}", static_cast<int>(c));
+                else
+                    ret += c;
+        }
+    }
+
+    return ret;
+}
+
+void enable(const std::filesystem::path& output)
+{
+    if (enabled)
+        return;
+
+    enabled     = true;
+    output_path = output;
+    std::atexit(write);
+}
+
+void add_span(const std::string_view category, const std::string_view name, const time_point_t start,
+              const time_point_t end)
+{
+    if (!enabled)
+        return;
+
+    events.push_back({ std::string(category), std::string(name), 'X', to_us(start), to_us(end) - to_us(start) });
+}
+
+void count(const std::string_view counter)
+{
+    if (!enabled)
+        return;
+
+    if (const auto& it = counters.find(counter); it != counters.end())
+        ++it->second;
+    else
+        counters.emplace(counter, 1);
+}
+
+void record_spawn(const std::string_view command)
+{
+    if (!enabled)
+        return;
+
+    count("spawn");
+    events.push_back({ "spawn", std::string(command), 'i', to_us(std::chrono::steady_clock::now()), 0 });
+}
+
+void write()
+{
+    if (!enabled || output_path.empty())
+        return;
+
+    const int   pid = getpid();
+    std::string buf = "{\"traceEvents\":[\n";
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        const event_t& event = events[i];
+        buf += fmt::format(R"({{"name":"{}","cat":"{}","ph":"{}","ts":{},"pid":{},"tid":{})",
+                           json_escape(event.name), json_escape(event.category), event.phase, event.ts, pid, pid);
+        if (event.phase == 'X')
+            buf += fmt::format(R"(,"dur":{})", event.dur);
+        else
+            buf += R"(,"s":"t")";
+        buf += (i + 1 < events.size()) ? "},\n" : "}\n";
+    }
+
+    buf += "],\n\"displayTimeUnit\":\"ms\",\n\"otherData\":{\"counters\":{";
+    for (auto it = counters.begin(); it != counters.end(); ++it)
+        buf += fmt::format(R"({}"{}":{})", it == counters.begin() ? "" : ",", json_escape(it->first), it->second);
+    buf += "}}}\n";
+
+    std::ofstream f(output_path, std::ios::trunc);
+    if (!f.is_open())
+    {
+        error(_("Failed to write the profile report to '{}'"), output_path.string());
+        return;
+    }
+
+    f << buf;
+    debug("profile report written to {}", output_path.string());
+}
+
+}  // namespace Profile
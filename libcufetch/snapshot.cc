@@ -0,0 +1,229 @@
+/*
+ * Copyright 2025 Toni500git
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "snapshot.hpp"
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+
+#include "fmt/format.h"
+#include "profile.hpp"
+#include "util.hpp"
+
+// header: magic, version, key, number of entries
+// entry:  expiration (ms since boot, suspend included), module, output
+constexpr std::string_view SNAPSHOT_MAGIC   = "CFSNAP";
+constexpr std::uint32_t    SNAPSHOT_VERSION = 2;
+constexpr std::uint64_t    NEVER_EXPIRES    = UINT64_MAX;
+
+namespace Snapshot
+{
+
+bool enabled = false;
+
+struct entry_t
+{
+    std::uint64_t expires;
+    std::string   value;
+};
+
+static std::filesystem::path                    snapshot_path;
+static std::string                              snapshot_key;
+static lifetime_func_t                          get_lifetime;
+static std::unordered_map<std::string, entry_t> entries;
+static bool                                     changed = false;
+
+// CLOCK_BOOTTIME keeps running while suspended, unlike steady_clock,
+// so the intervals of the modules aren't stretched by the time spent asleep
+static std::uint64_t now_ms()
+{
+#if defined(CLOCK_BOOTTIME)
+    struct timespec ts;
+    if (clock_gettime(CLOCK_BOOTTIME, &ts) == 0)
+        return static_cast<std::uint64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+#endif
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+template <typename T>
+static void snapshot_put(std::string& buf, const T n)
+{ buf.append(reinterpret_cast<const char*>(&n), sizeof(n)); }
+
+static void snapshot_put_str(std::string& buf, const std::string_view str)
+{
+    snapshot_put<std::uint32_t>(buf, str.length());
+    buf.append(str);
+}
+
+struct snapshot_reader_t
+{
+    std::string_view data;
+    size_t           pos = 0;
+
+    template <typename T>
+    bool get(T& n)
+    {
+        if (data.size() - pos < sizeof(n))
+            return false;
+        std::memcpy(&n, data.data() + pos, sizeof(n));
+        pos += sizeof(n);
+        return true;
+    }
+
+    bool get_str(std::string_view& str)
+    {
+        std::uint32_t len = 0;
+        if (!get(len) || data.size() - pos < len)
+            return false;
+        str = data.substr(pos, len);
+        pos += len;
+        return true;
+    }
+};
+
+static bool read_snapshot(const std::string_view data)
+{
+    snapshot_reader_t reader{ data };
+    std::uint32_t     version = 0, n_entries = 0;
+    std::string_view  key;
+    if (data.substr(0, SNAPSHOT_MAGIC.length()) != SNAPSHOT_MAGIC)
+        return false;
+
+    reader.pos = SNAPSHOT_MAGIC.length();
+    if (!reader.get(version) || version != SNAPSHOT_VERSION || !reader.get_str(key) || key != snapshot_key ||
+        !reader.get(n_entries))
+        return false;
+
+    const std::uint64_t now = now_ms();
+    for (std::uint32_t i = 0; i < n_entries; ++i)
+    {
+        std::uint64_t    expires = 0;
+        std::string_view module, value;
+        if (!reader.get(expires) || !reader.get_str(module) || !reader.get_str(value))
+            return false;
+
+        // drop the expired ones, they'll be evaluated and saved again
+        if (expires > now)
+            entries.emplace(module, entry_t{ expires, std::string(value) });
+        else
+            changed = true;
+    }
+
+    return reader.pos == data.size();
+}
+
+void load(const std::filesystem::path& path, const std::string& key, const lifetime_func_t& lifetime,
+          const bool refresh)
+{
+    enabled       = true;
+    snapshot_path = path;
+    snapshot_key  = key;
+    get_lifetime  = lifetime;
+    entries.clear();
+
+    if (!refresh)
+    {
+        std::ifstream     f(path, std::ios::binary);
+        const std::string data{ std::istreambuf_iterator<char>{ f }, std::istreambuf_iterator<char>{} };
+        if (f.is_open() && read_snapshot(data))
+        {
+            debug("snapshot: loaded {} values from {}", entries.size(), path.string());
+            return;
+        }
+    }
+
+    debug("snapshot: not using {}", path.string());
+    entries.clear();
+    changed = true;
+}
+
+bool get(const std::string& module, std::string& value)
+{
+    const auto& it = entries.find(module);
+    if (it == entries.end() || it->second.expires <= now_ms())
+        return false;
+
+    Profile::count("cache_hit.snapshot");
+    value = it->second.value;
+    return true;
+}
+
+void put(const std::string& module, const std::string_view path, const std::string& value)
+{
+    const std::chrono::milliseconds lifetime = get_lifetime(path);
+    if (lifetime.count() <= 0)
+        return;
+
+    const std::uint64_t expires =
+        (lifetime == std::chrono::milliseconds::max()) ? NEVER_EXPIRES : now_ms() + lifetime.count();
+    entries.insert_or_assign(module, entry_t{ expires, value });
+    changed = true;
+}
+
+void save()
+{
+    if (!enabled || !changed)
+        return;
+
+    std::string buf{ SNAPSHOT_MAGIC };
+    snapshot_put(buf, SNAPSHOT_VERSION);
+    snapshot_put_str(buf, snapshot_key);
+    snapshot_put<std::uint32_t>(buf, entries.size());
+    for (const auto& [module, entry] : entries)
+    {
+        snapshot_put(buf, entry.expires);
+        snapshot_put_str(buf, module);
+        snapshot_put_str(buf, entry.value);
+    }
+
+    // write it in a temporary file first, so another instance never reads it half written
+    std::error_code ec;
+    std::filesystem::create_directories(snapshot_path.parent_path(), ec);
+    const std::filesystem::path& tmp_path = fmt::format("{}.{}", snapshot_path.string(), getpid());
+    std::ofstream                f(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!f.write(buf.data(), buf.size()))
+        return;
+
+    f.close();
+    std::filesystem::rename(tmp_path, snapshot_path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tmp_path, ec);
+        return;
+    }
+
+    changed = false;
+    debug("snapshot: wrote {} values to {}", entries.size(), snapshot_path.string());
+}
+
+}  // namespace Snapshot
@@ -0,0 +1,92 @@
+#!/bin/sh
+# Benchmarks of the output of customfetch.
+#
+# live: bytes written by the live mode (--loop-ms=200) in a 50x120 terminal,
+# in total and for each frame, for each customfetch given.
+#
+# compose: median time of the render phase (from --profile) of a logo next to a layout
+# without modules, with an offset of 40%, in a 80 and 300 columns terminal.
+# It includes loading the logo, so it's meant to compare the customfetch given to each other.
+#
+# They need script(1) from util-linux for the pseudo-terminal.
+#
+# It uses the default config, or the one in $CONFIG.
+
+usage() {
+	echo "usage: $0 live|compose <customfetch>..."
+	exit 1
+}
+
+[ -z "$2" ] && usage
+mode=$1
+shift
+
+self=$(realpath "$0")
+bins=""
+for bin in "$@"; do
+	bins="$bins $(realpath "$bin")" || exit 1
+done
+bins=${bins# }
+cd "$(dirname "$self")/../.." || exit 1
+
+[ -n "$CONFIG" ] && config=$(realpath "$CONFIG")
+
+# don't use (or touch) the user config, cache and snapshot
+tmphome=$(mktemp -d)
+trap 'rm -rf "$tmphome"' EXIT
+export HOME="$tmphome"
+export XDG_CONFIG_HOME="$tmphome/.config"
+export XDG_CACHE_HOME="$tmphome/.cache"
+
+# how long the live mode runs, in seconds
+secs=${SECS:-2}
+
+live() {
+	for bin in $bins; do
+		# the signal has to be sent inside the pty, script forwards it to all its process group
+		LD_LIBRARY_PATH="$(dirname "$bin")${LD_LIBRARY_PATH:+:$LD_LIBRARY_PATH}" \
+			script -qfc "stty rows 50 cols 120; timeout $secs '$bin' ${config:+-C '$config'} -D assets --loop-ms=200" /dev/null \
+			</dev/null >"$tmphome/out" 2>/dev/null
+		bytes=$(wc -c <"$tmphome/out")
+		frames=$((secs * 1000 / 200))
+		echo "$bin: $bytes bytes in ${secs}s, $((bytes / frames)) bytes/frame"
+	done
+}
+
+# run a customfetch in a pty of $1 rows and $2 columns
+run_pty() {
+	rows=$1
+	cols=$2
+	bin=$3
+	shift 3
+	LD_LIBRARY_PATH="$(dirname "$bin")${LD_LIBRARY_PATH:+:$LD_LIBRARY_PATH}" \
+		script -qfc "stty rows $rows cols $cols; '$bin' $*" /dev/null </dev/null >/dev/null 2>&1
+}
+
+compose() {
+	runs=${RUNS:-100}
+	layout=""
+	i=0
+	while [ $i -lt 20 ]; do
+		layout="$layout -m 'layout line $i'"
+		i=$((i + 1))
+	done
+
+	for cols in 80 300; do
+		for bin in $bins; do
+			i=0
+			while [ $i -lt "$runs" ]; do
+				run_pty 50 $cols "$bin" -D assets -o 40% $layout --profile="$tmphome/profile.json"
+				grep -o '"name":"render","cat":"phase"[^}]*' "$tmphome/profile.json" | sed 's/.*"dur"://'
+				i=$((i + 1))
+			done | sort -n | awk -v bin="$bin" -v cols=$cols \
+				'{ t[NR] = $1 } END { printf "%s: %d cols, render %d us (median)\n", bin, cols, t[int((NR + 1) / 2)] }'
+		done
+	done
+}
+
+case $mode in
+	live) live ;;
+	compose) compose ;;
+	*) usage ;;
+esac
@@ -0,0 +1,141 @@
+#!/bin/sh
+# Training workload for the PGO build (make pgo).
+# It runs customfetch with every logo in assets/ascii and every config in examples/,
+# once for each synthetic machine in scripts/pgo/machines/.
+# The machine files are bind-mounted over /proc, /etc and /sys/class in a user namespace,
+# or if unshare isn't available, it trains on the real machine.
+#
+# With --bench it prints instead the startup and render time of each customfetch given,
+# compared to the first one, on the first machine.
+
+usage() {
+	echo "usage: $0 <customfetch>"
+	echo "       $0 --bench <customfetch>..."
+	exit 1
+}
+
+[ -z "$1" ] && usage
+
+mode=train
+if [ "$1" = "--bench" ]; then
+	mode=bench
+	shift
+	[ -z "$1" ] && usage
+fi
+
+# resolve the paths before moving to the repo root
+self=$(realpath "$0")
+bins=""
+for bin in "$@"; do
+	bins="$bins $(realpath "$bin")" || exit 1
+done
+bins=${bins# }
+cd "$(dirname "$self")/../.." || exit 1
+
+# don't use (or touch) the user config, cache and snapshot
+tmphome=$(mktemp -d)
+trap 'rm -rf "$tmphome"' EXIT
+export HOME="$tmphome"
+export XDG_CONFIG_HOME="$tmphome/.config"
+export XDG_CACHE_HOME="$tmphome/.cache"
+
+run() {
+	bin=$1
+	shift
+	LD_LIBRARY_PATH="$(dirname "$bin")${LD_LIBRARY_PATH:+:$LD_LIBRARY_PATH}" "$bin" "$@" >/dev/null 2>&1 </dev/null
+}
+
+train() {
+	bin=$bins
+	run "$bin" --gen-config "$tmphome/config.toml"
+	n=0
+	for config in "$tmphome/config.toml" examples/*.toml; do
+		for logo in assets/ascii/*.txt; do
+			case $((n % 3)) in
+				0) pos=top ;;
+				1) pos=left ;;
+				2) pos=bottom ;;
+			esac
+			run "$bin" -C "$config" -D assets -s "$logo" -p $pos $1
+			n=$((n + 1))
+		done
+		run "$bin" -C "$config" -D assets --list-modules
+	done
+	run "$bin" -D assets --list-logos
+}
+
+# nanoseconds spent on running a customfetch command
+time_ns() {
+	start=$(date +%s%N)
+	run "$@"
+	end=$(date +%s%N)
+	echo $((end - start))
+}
+
+# nanoseconds spent in the render phase, from the --profile report
+render_ns() {
+	run "$1" -D assets --profile="$tmphome/profile.json"
+	dur=$(grep -o '"name":"render","cat":"phase"[^}]*' "$tmphome/profile.json" | sed 's/.*"dur"://')
+	echo $((${dur:-0} * 1000))
+}
+
+bench() {
+	# the binaries run in turn at each round, so they get the same noise
+	runs=${RUNS:-100}
+	times="$tmphome/times"
+	i=0
+	while [ $i -lt "$runs" ]; do
+		for bin in $bins; do
+			# the whole run with a layout without modules, then only the render of the default config
+			echo "$bin startup $(time_ns "$bin" -n -m "customfetch")" >> "$times"
+			echo "$bin render $(render_ns "$bin")" >> "$times"
+		done
+		i=$((i + 1))
+	done
+
+	for bin in $bins; do
+		for kind in startup render; do
+			grep "^$bin $kind " "$times" | cut -d' ' -f3 | sort -n |
+				awk '{ t[NR] = $1 } END { printf "%.2f ", t[int((NR + 1) / 2)] / 1000000 }'
+		done
+		echo "$bin"
+	done | awk '
+		NR == 1 { base_startup = $1; base_render = $2; printf "%s: startup %s ms, render %s ms (median)\n", $3, $1, $2; next }
+		{ printf "%s: startup %s ms (%+.1f%%), render %s ms (%+.1f%%) (median)\n", $3, $1, ($1 / base_startup - 1) * 100, $2, ($2 / base_render - 1) * 100 }'
+}
+
+if [ -n "$CUFETCH_PGO_MACHINE" ]; then
+	# we're in the namespace of the machine.
+	# sys/class is mounted whole, since most of its entries don't exist everywhere
+	for file in $(cd "$CUFETCH_PGO_MACHINE" && find proc etc -type f); do
+		mount --bind "$CUFETCH_PGO_MACHINE/$file" "/$file" || exit 1
+	done
+	mount --bind "$CUFETCH_PGO_MACHINE/sys/class" /sys/class || exit 1
+
+	if [ $mode = bench ]; then
+		bench
+	else
+		train "$CUFETCH_PGO_ARGS"
+	fi
+elif command -v unshare >/dev/null && unshare --user --map-root-user --mount true 2>/dev/null; then
+	[ $mode = bench ] && flag="--bench" || flag=""
+	args=""
+	for machine in scripts/pgo/machines/*/; do
+		[ $mode = train ] && echo "Training on $machine"
+		# shellcheck disable=SC2086
+		CUFETCH_PGO_MACHINE="$PWD/$machine" CUFETCH_PGO_ARGS="$args" \
+			unshare --user --map-root-user --mount "$self" $flag $bins || exit 1
+		[ $mode = bench ] && break
+
+		# alternate colored and not colored output
+		[ -z "$args" ] && args="-N" || args=""
+	done
+else
+	echo "Can't create a user namespace, using this machine"
+	if [ $mode = bench ]; then
+		bench
+	else
+		train ""
+		train "-N"
+	fi
+fi
@@ -25,11 +25,23 @@
 
 #include "config.hpp"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "fmt/os.h"
+#include "profile.hpp"
+#include "switch_fnv1a.hpp"
 #include "texts.hpp"
 #include "util.hpp"
 
@@ -48,20 +60,421 @@ Config::Config(const std::filesystem::path& configFile, const std::filesystem::p
     }
 }
 
+// Binary image of the parsed config file, so we don't have to parse the TOML at every run.
+// It's only the values ConfigBase can read (strings, integers, booleans and arrays of strings)
+// flattened with their full key path, invalidated when the config file changes.
+//
+// header: magic, version, config mtime (ns), size, inode, config path
+// entry:  type, number of keys, keys, value
+// array:  number of elements, then the type and value of each element
+constexpr std::string_view CONFIG_CACHE_MAGIC   = "CFCONF";
+constexpr std::uint32_t    CONFIG_CACHE_VERSION = 2;
+
+enum config_cache_type_t : std::uint8_t
+{
+    CACHE_STR,
+    CACHE_INT,
+    CACHE_BOOL,
+    CACHE_ARRAY
+};
+
+struct config_cache_key_t
+{
+    std::uint64_t mtime = 0;
+    std::uint64_t size  = 0;
+    std::uint64_t inode = 0;
+    std::string   path;
+};
+
+// One cache for each config file, so switching between them (e.g with -C) doesn't rewrite it at every run
+static std::filesystem::path get_config_cache_path(const config_cache_key_t& key)
+{
+    return getCacheDir() / fmt::format("config-cache-{:016x}", fnv1a64::hash(key.path.data(), key.path.length()));
+}
+
+static bool get_config_cache_key(const std::filesystem::path& filename, config_cache_key_t& key)
+{
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0)
+        return false;
+
+    key.mtime = static_cast<std::uint64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    key.size  = st.st_size;
+    key.inode = st.st_ino;
+    std::error_code ec;
+    key.path = std::filesystem::weakly_canonical(filename, ec).string();
+    if (ec)
+        key.path = std::filesystem::absolute(filename).string();
+    return true;
+}
+
+template <typename T>
+static void cache_put(std::string& buf, const T n)
+{ buf.append(reinterpret_cast<const char*>(&n), sizeof(n)); }
+
+static void cache_put_str(std::string& buf, const std::string_view str)
+{
+    cache_put<std::uint32_t>(buf, str.length());
+    buf.append(str);
+}
+
+// Returns false if the array has something we can't store (floats, tables, other arrays, ...)
+static bool cache_put_array(std::string& buf, const toml::array& array)
+{
+    cache_put<std::uint32_t>(buf, array.size());
+    for (const toml::node& el : array)
+    {
+        if (const toml::value<std::string>* str = el.as_string())
+        {
+            cache_put<std::uint8_t>(buf, CACHE_STR);
+            cache_put_str(buf, str->get());
+        }
+        else if (const toml::value<int64_t>* num = el.as_integer())
+        {
+            cache_put<std::uint8_t>(buf, CACHE_INT);
+            cache_put<std::int64_t>(buf, num->get());
+        }
+        else if (const toml::value<bool>* boolean = el.as_boolean())
+        {
+            cache_put<std::uint8_t>(buf, CACHE_BOOL);
+            cache_put<std::uint8_t>(buf, boolean->get());
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Returns false if the table has something we can't store (floats, dates, ...)
+static bool flatten_table(const toml::table& tbl, std::vector<std::string_view>& keys, std::string& buf,
+                          std::uint32_t& n_entries)
+{
+    for (const auto& [k, node] : tbl)
+    {
+        keys.push_back(k.str());
+
+        const auto put_keys = [&](const config_cache_type_t type) {
+            cache_put<std::uint8_t>(buf, type);
+            cache_put<std::uint32_t>(buf, keys.size());
+            for (const std::string_view key : keys)
+                cache_put_str(buf, key);
+            ++n_entries;
+        };
+
+        if (const toml::table* table = node.as_table())
+        {
+            if (!flatten_table(*table, keys, buf, n_entries))
+                return false;
+        }
+        else if (const toml::value<std::string>* str = node.as_string())
+        {
+            put_keys(CACHE_STR);
+            cache_put_str(buf, str->get());
+        }
+        else if (const toml::value<int64_t>* num = node.as_integer())
+        {
+            put_keys(CACHE_INT);
+            cache_put<std::int64_t>(buf, num->get());
+        }
+        else if (const toml::value<bool>* boolean = node.as_boolean())
+        {
+            put_keys(CACHE_BOOL);
+            cache_put<std::uint8_t>(buf, boolean->get());
+        }
+        else if (const toml::array* array = node.as_array())
+        {
+            // getValueArrayStr() only takes the strings, but the other elements
+            // can still be read by their index (e.g "config.array[1]")
+            put_keys(CACHE_ARRAY);
+            if (!cache_put_array(buf, *array))
+                return false;
+        }
+        else
+        {
+            return false;
+        }
+
+        keys.pop_back();
+    }
+
+    return true;
+}
+
+static void write_config_cache(const std::filesystem::path& cache_path, const config_cache_key_t& key,
+                               const toml::table& tbl)
+{
+    std::string                   entries;
+    std::vector<std::string_view> keys;
+    std::uint32_t                 n_entries = 0;
+    if (!flatten_table(tbl, keys, entries, n_entries))
+    {
+        debug("config cache: the config has values that can't be cached, not writing it");
+        std::error_code ec;
+        std::filesystem::remove(cache_path, ec);
+        return;
+    }
+
+    std::string buf{ CONFIG_CACHE_MAGIC };
+    cache_put(buf, CONFIG_CACHE_VERSION);
+    cache_put(buf, key.mtime);
+    cache_put(buf, key.size);
+    cache_put(buf, key.inode);
+    cache_put_str(buf, key.path);
+    cache_put(buf, n_entries);
+    buf += entries;
+
+    // write it in a temporary file first, so another instance never reads it half written
+    std::error_code ec;
+    std::filesystem::create_directories(cache_path.parent_path(), ec);
+    const std::filesystem::path& tmp_path = fmt::format("{}.{}", cache_path.string(), getpid());
+    std::ofstream                f(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!f.write(buf.data(), buf.size()))
+        return;
+
+    f.close();
+    std::filesystem::rename(tmp_path, cache_path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tmp_path, ec);
+        return;
+    }
+    debug("config cache: wrote {} values to {}", n_entries, cache_path.string());
+}
+
+struct config_cache_reader_t
+{
+    std::string_view data;
+    size_t           pos = 0;
+
+    template <typename T>
+    bool get(T& n)
+    {
+        if (data.size() - pos < sizeof(n))
+            return false;
+        std::memcpy(&n, data.data() + pos, sizeof(n));
+        pos += sizeof(n);
+        return true;
+    }
+
+    bool get_str(std::string_view& str)
+    {
+        std::uint32_t len = 0;
+        if (!get(len) || data.size() - pos < len)
+            return false;
+        str = data.substr(pos, len);
+        pos += len;
+        return true;
+    }
+};
+
+static bool read_config_cache_entries(config_cache_reader_t& reader, const config_cache_key_t& key, toml::table& tbl)
+{
+    std::uint32_t      version = 0, n_entries = 0;
+    config_cache_key_t cached;
+    std::string_view   path;
+    if (reader.data.substr(0, CONFIG_CACHE_MAGIC.length()) != CONFIG_CACHE_MAGIC)
+        return false;
+
+    reader.pos = CONFIG_CACHE_MAGIC.length();
+    if (!reader.get(version) || version != CONFIG_CACHE_VERSION || !reader.get(cached.mtime) ||
+        !reader.get(cached.size) || !reader.get(cached.inode) || !reader.get_str(path) || !reader.get(n_entries))
+        return false;
+
+    if (cached.mtime != key.mtime || cached.size != key.size || cached.inode != key.inode || path != key.path)
+        return false;
+
+    for (std::uint32_t i = 0; i < n_entries; ++i)
+    {
+        std::uint8_t  type   = 0;
+        std::uint32_t n_keys = 0;
+        if (!reader.get(type) || !reader.get(n_keys) || n_keys == 0)
+            return false;
+
+        // walk (and create) the parent tables
+        toml::table*     table = &tbl;
+        std::string_view name;
+        for (std::uint32_t j = 0; j < n_keys; ++j)
+        {
+            if (!reader.get_str(name))
+                return false;
+            if (j + 1 == n_keys)
+                break;
+
+            table = table->emplace<toml::table>(name).first->second.as_table();
+            if (!table)
+                return false;
+        }
+
+        switch (type)
+        {
+            case CACHE_STR:
+            {
+                std::string_view str;
+                if (!reader.get_str(str))
+                    return false;
+                table->insert_or_assign(name, std::string(str));
+                break;
+            }
+            case CACHE_INT:
+            {
+                std::int64_t num = 0;
+                if (!reader.get(num))
+                    return false;
+                table->insert_or_assign(name, num);
+                break;
+            }
+            case CACHE_BOOL:
+            {
+                std::uint8_t boolean = 0;
+                if (!reader.get(boolean))
+                    return false;
+                table->insert_or_assign(name, boolean != 0);
+                break;
+            }
+            case CACHE_ARRAY:
+            {
+                std::uint32_t n_elements = 0;
+                if (!reader.get(n_elements))
+                    return false;
+
+                toml::array array;
+                for (std::uint32_t j = 0; j < n_elements; ++j)
+                {
+                    std::uint8_t     el_type = 0;
+                    std::string_view str;
+                    std::int64_t     num     = 0;
+                    std::uint8_t     boolean = 0;
+                    if (!reader.get(el_type))
+                        return false;
+
+                    if (el_type == CACHE_STR && reader.get_str(str))
+                        array.push_back(std::string(str));
+                    else if (el_type == CACHE_INT && reader.get(num))
+                        array.push_back(num);
+                    else if (el_type == CACHE_BOOL && reader.get(boolean))
+                        array.push_back(boolean != 0);
+                    else
+                        return false;
+                }
+                table->insert_or_assign(name, std::move(array));
+                break;
+            }
+            default: return false;
+        }
+    }
+
+    return reader.pos == reader.data.size();
+}
+
+static bool read_config_cache(const std::filesystem::path& cache_path, const config_cache_key_t& key, toml::table& tbl)
+{
+    const int fd = open(cache_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return false;
+
+    config_cache_reader_t reader{ std::string_view(static_cast<const char*>(map), st.st_size) };
+    const bool            ret = read_config_cache_entries(reader, key, tbl);
+    munmap(map, st.st_size);
+
+    if (!ret)
+        tbl.clear();
+    return ret;
+}
+
 void Config::loadConfigFile(const std::filesystem::path& filename)
 {
+    Profile::Span                span("phase", "config");
+    config_cache_key_t           cache_key;
+    const bool                   has_key    = get_config_cache_key(filename, cache_key);
+    const std::filesystem::path& cache_path = get_config_cache_path(cache_key);
+
+    this->tbl.clear();
+    if (has_key && !this->args_rebuild_cache && read_config_cache(cache_path, cache_key, this->tbl))
+    {
+        debug("config cache: using {}", cache_path.string());
+        Profile::count("cache_hit.config");
+    }
+    else
+    {
+        try
+        {
+            this->tbl = toml::parse_file(filename.string());
+        }
+        catch (const toml::parse_error& err)
+        {
+            die(_("Parsing config file '{}' failed:\n"
+                  "{}\n"
+                  "\t(error occurred at line {} column {})"),
+                filename.string(), err.description(), err.source().begin.line, err.source().begin.column);
+        }
+
+        if (has_key)
+            write_config_cache(cache_path, cache_key, this->tbl);
+    }
+
+    // the arguments are parsed before the config
+    this->args_alias_colors = this->colors_name.size();
+    this->loadValues();
+}
+
+Config::reload_t Config::reloadConfigFile(const std::filesystem::path& filename)
+{
+    toml::table new_tbl;
     try
     {
-        this->tbl = toml::parse_file(filename.string());
+        new_tbl = toml::parse_file(filename.string());
     }
     catch (const toml::parse_error& err)
     {
-        die(_("Parsing config file '{}' failed:\n"
-              "{}\n"
-              "\t(error occurred at line {} column {})"),
-            filename.string(), err.description(), err.source().begin.line, err.source().begin.column);
+        // keep going with the old config, the user is probably still editing it
+        error(_("Parsing config file '{}' failed, keeping the old config:\n"
+                "{}\n"
+                "\t(error occurred at line {} column {})"),
+              filename.string(), err.description(), err.source().begin.line, err.source().begin.column);
+        return RELOAD_FAILED;
     }
 
+    if (new_tbl == this->tbl)
+        return RELOAD_UNCHANGED;
+
+    config_cache_key_t cache_key;
+    if (get_config_cache_key(filename, cache_key))
+        write_config_cache(get_config_cache_path(cache_key), cache_key, new_tbl);
+
+    // the layout lines and their intervals are checked at every render,
+    // see if anything else changed
+    toml::table old_tbl = std::move(this->tbl);
+    this->tbl           = std::move(new_tbl);
+    this->loadValues(true);
+
+    new_tbl = this->tbl;
+    for (toml::table* table : { &old_tbl, &new_tbl })
+    {
+        table->erase("live-intervals");
+        if (toml::table* config_tbl = (*table)["config"].as_table())
+            config_tbl->erase("layout");
+    }
+
+    return (old_tbl == new_tbl) ? RELOAD_LAYOUT : RELOAD_ALL;
+}
+
+void Config::loadValues(const bool reloading)
+{
     // clang-format off
     // Idk but with `this->` looks more readable
     this->layout              = getValueArrayStr("config.layout", {});
@@ -94,6 +507,24 @@ void Config::loadConfigFile(const std::filesystem::path& filename)
     this->flatpak_dirs = getValueArrayStr("os.pkgs.flatpak-dirs", {"/var/lib/flatpak/app", "~/.local/share/flatpak/app"});
     this->apk_files    = getValueArrayStr("os.pkgs.apk-files",    {"/var/lib/apk/db/installed"});
 
+    const int cpu_usage_sample_ms = getValueInt("cpu.usage.sample-ms", 100);
+    if (cpu_usage_sample_ms < 0)
+        warn(_("cpu.usage.sample-ms must be a positive number of milliseconds, using 100"));
+    this->cpu_usage_sample_ms = (cpu_usage_sample_ms < 0) ? 100 : cpu_usage_sample_ms;
+
+    this->live_intervals.clear();
+    if (const toml::table* intervals = this->tbl["live-intervals"].as_table())
+    {
+        for (const auto& [module, interval] : *intervals)
+        {
+            if (const std::optional<int64_t>& ms = interval.value<int64_t>(); ms && *ms >= 0)
+                this->live_intervals[std::string(module.str())] = *ms;
+            else
+                warn(_("live-intervals: the interval of '{}' must be a positive number of milliseconds"),
+                     module.str());
+        }
+    }
+
     this->colors.black       = getValueStr("config.black",   "\033[1;30m");
     this->colors.red         = getValueStr("config.red",     "\033[1;31m");
     this->colors.green       = getValueStr("config.green",   "\033[1;32m");
@@ -119,12 +550,22 @@ void Config::loadConfigFile(const std::filesystem::path& filename)
         this->percentage_colors = {"green", "yellow", "red"};
     }
 
+    this->colors_name.resize(this->args_alias_colors);
+    this->colors_value.resize(this->args_alias_colors);
     for (const std::string& str : this->getValueArrayStr("config.alias-colors", {}))
-        this->addAliasColors(str);
+    {
+        if (reloading && str.find('=') == str.npos)
+            warn(_("alias color '{}' does NOT have an equal sign '=' for separating color name and value, skipping it"),
+                 str);
+        else
+            this->addAliasColors(str);
+    }
 
     const char *no_color = std::getenv("NO_COLOR");
     if (no_color != NULL && no_color[0] != '\0')
         this->args_disable_colors = true;
+
+    this->resolveValues();
 }
 
 void Config::addAliasColors(const std::string& str)
@@ -177,6 +618,8 @@ void Config::overrideOption(const std::string& opt)
     else
         die(_("looks like override value '{}' from '{}' is neither a bool, int or string value"), 
             value, name);
+
+    this->resolveValues();
 }
 
 void Config::generateConfig(const std::filesystem::path &filename)
@@ -101,6 +101,19 @@ MODFUNC(battery_vendor)
 MODFUNC(battery_capacity_level)
 { return MAGIC_LINE; }
 
+MODFUNC(battery_cycle_count)
+{ return MAGIC_LINE; }
+
+MODFUNC(battery_energy_now)
+{ return MAGIC_LINE; }
+
+MODFUNC(battery_power_now)
+{ return MAGIC_LINE; }
+
+// there's only one battery
+MODFUNC(battery_total_perc)
+{ return battery_perc(callbackInfo); }
+
 // clang-format on
 MODFUNC(battery_status)
 {
@@ -138,7 +151,7 @@ MODFUNC(battery_perc)
     return doc["percentage"];
 }
 
-double battery_temp()
+double battery_temp(const callbackInfo_t*)
 {
     if (!assert_doc())
         return std::stod(read_value_dumpsys("temperature")) / 10;
@@ -66,7 +66,7 @@ unsigned long os_uptime()
     if (clock_gettime(CLOCK_BOOTTIME, &uptime) != 0)
         return 0;
 
-    return (uint64_t)uptime.tv_sec + (uint64_t)uptime.tv_nsec / 1000000;
+    return uptime.tv_sec;
 }
 
 #endif
@@ -31,6 +31,7 @@
 #include <string>
 
 #include "core-modules.hh"
+#include "profile.hpp"
 #include "tiny-process-library/process.hpp"
 #include "util.hpp"
 
@@ -52,6 +53,7 @@ MODFUNC(user_shell_version)
     const std::string& shell_name = user_shell_name(callbackInfo);
     std::string        ret;
 
+    Profile::record_spawn(shell_name);
     if (shell_name == "nu")
         Process("nu -c \"version | get version\"", "", [&](const char* bytes, size_t n) { ret.assign(bytes, n); });
     else
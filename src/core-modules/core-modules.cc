@@ -33,6 +33,7 @@
 #include <cstdio>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <utility>
 
 #include "config.hpp"
@@ -40,6 +41,7 @@
 #include "libcufetch/cufetch.hh"
 #include "linux/utils/packages.hh"
 #include "platform.hpp"
+#include "profile.hpp"
 #include "switch_fnv1a.hpp"
 #include "util.hpp"
 
@@ -219,6 +221,24 @@ MODFUNC(battery_fmt)
         battery_status(callbackInfo));
 }
 
+MODFUNC(cpu_usage_fmt)
+{
+    const std::string& usage = cpu_usage_total(callbackInfo);
+    if (usage == UNKNOWN || usage == MAGIC_LINE)
+        return usage;
+
+    return get_and_color_percentage(std::stod(usage), 100, callbackInfo->parse_args, false);
+}
+
+MODFUNC(battery_total_fmt)
+{
+    const std::string& perc = battery_total_perc(callbackInfo);
+    if (perc == UNKNOWN || perc == MAGIC_LINE)
+        return perc;
+
+    return get_and_color_percentage(std::stod(perc), 100, callbackInfo->parse_args, true);
+}
+
 MODFUNC(theme_cursor_fmt)
 {
     const std::string& size = theme_cursor_size(callbackInfo);
@@ -229,20 +249,91 @@ MODFUNC(theme_cursor_fmt)
     return fmt::format("{} ({}px)", name, size);
 }
 
+/* Modules whose output can't change while customfetch is running.
+ * In live mode they are computed only once, unless an interval is set for them in [live-intervals].
+ * Everything else (uptime, frequencies, usage, memory, disks, battery, temperatures, theme and packages)
+ * and modules from plugins are dynamic, and evaluated again at every tick.
+ *
+ * The most specific path wins, e.g $<cpu.freq> is dynamic but $<cpu.name> is static.
+ */
+static const std::unordered_map<std::string_view, bool> static_modules = {
+    {"os.name",     true},
+    {"os.kernel",   true},
+    {"os.hostname", true},
+    {"os.initsys",  true},
+    {"system",      true},
+    {"cpu",         true},
+    {"cpu.freq",    false},
+    {"cpu.temp",    false},
+    {"cpu.usage",   false},
+    {"user",        true},
+    {"gpu",         true},
+    {"title",       true},
+    {"colors",      true},
+};
+
+bool is_module_static(std::string_view path)
+{
+    while (true)
+    {
+        if (const auto& it = static_modules.find(path); it != static_modules.end())
+            return it->second;
+
+        const size_t dot = path.rfind('.');
+        if (dot == path.npos)
+            return false;
+        path.remove_suffix(path.length() - dot);
+    }
+}
+
+/* Modules that depend on where customfetch is started from (the terminal, the shell and the desktop session),
+ * which can be different at each run even if they're static.
+ */
+static constexpr std::array<std::string_view, 4> session_modules = {
+    "user.terminal", "user.shell", "user.wm", "user.de"
+};
+
+bool is_module_per_session(const std::string_view path)
+{
+    return std::any_of(session_modules.begin(), session_modules.end(), [&](const std::string_view module) {
+        return hasStart(path, module) && (path.length() == module.length() || path[module.length()] == '.');
+    });
+}
+
+std::string get_module_arg(const callbackInfo_t* callbackInfo, const std::string_view name)
+{
+    if (!callbackInfo)
+        return "";
+
+    const moduleArgs_t* moduleArg = callbackInfo->module_args;
+    for (; moduleArg && moduleArg->name != name; moduleArg = moduleArg->next)
+        ;
+    return moduleArg ? moduleArg->value : "";
+}
+
+size_t get_module_index(const callbackInfo_t* callbackInfo, const std::string_view module)
+{
+    const size_t       pos   = module.rfind('.');
+    const std::string& value = get_module_arg(callbackInfo, pos == module.npos ? module : module.substr(pos + 1));
+    if (value.empty())
+        return 0;
+    if (!std::all_of(value.begin(), value.end(), ::isdigit))
+        die(_("Module {} argument must be a number, got '{}'"), module, value);
+
+    return std::stoul(value);
+}
+
 void core_plugins_start(const Config& config)
 {
     // ------------ INIT STUFF ------------
-    const size_t uptime_secs  = os_uptime();
-    const size_t uptime_mins  = uptime_secs / (60);
-    const size_t uptime_hours = uptime_secs / (60 * 60);
-    const size_t uptime_days  = uptime_secs / (60 * 60 * 24);
-
+    Profile::Span span_init("core", "init");
     if (uname(&g_uname_infos) != 0)
         die(_("uname() failed: {}\nCould not get system infos"), std::strerror(errno));
 
     if (g_pwd = getpwuid(getuid()), !g_pwd)
         die(_("getpwent failed: {}\nCould not get user infos"), std::strerror(errno));
 
+    Profile::Span span_term("core", "terminal");
     term_pid  = get_terminal_pid();
     term_name = get_terminal_name();
     if (hasStart(str_tolower(term_name), "login") || hasStart(term_name, "/dev/tty") || hasStart(term_name, "init") || hasStart(term_name, "(init)"))
@@ -250,6 +341,7 @@ void core_plugins_start(const Config& config)
         is_tty    = true;
         term_name = ttyname(STDIN_FILENO);
     }
+    span_term.end();
 #if !CF_MACOS
     os_release = fopen("/etc/os-release", "r");
     cpuinfo    = fopen("/proc/cpuinfo", "r");
@@ -261,6 +353,9 @@ void core_plugins_start(const Config& config)
     is_tty = true;
 #endif
 
+    cpu_usage_first_sample_ms = config.cpu_usage_sample_ms;
+    span_init.end();
+
     // ------------ MODULES REGISTERING ------------
     module_t os_name_pretty_module = {"pretty", "OS pretty name [Ubuntu 22.04.4 LTS; Arch Linux]", {}, os_pretty_name};
     module_t os_name_id_module = {"id", "OS id name [ubuntu, arch]", {}, os_name_id};
@@ -269,17 +364,20 @@ void core_plugins_start(const Config& config)
         std::move(os_name_id_module)
     }, os_name };
 
-    module_t os_uptime_s_module = {"secs", "uptime of the system in seconds [45]", {}, [=](unused) {return fmt::to_string(uptime_secs % 60);}};
-    module_t os_uptime_m_module = {"mins", "uptime of the system in minutes [12]", {}, [=](unused) {return fmt::to_string(uptime_mins % 60);}};
-    module_t os_uptime_h_module = {"hours", "uptime of the system in hours [34]", {}, [=](unused) {return fmt::to_string(uptime_hours % 24);}};
-    module_t os_uptime_d_module = {"days", "uptime of the system in days [2]", {}, [=](unused) {return fmt::to_string(uptime_days);}};
+    // uptime is read at each call, so it doesn't stay frozen in live mode
+    module_t os_uptime_s_module = {"secs", "uptime of the system in seconds [45]", {}, [](unused) {return fmt::to_string(os_uptime() % 60);}};
+    module_t os_uptime_m_module = {"mins", "uptime of the system in minutes [12]", {}, [](unused) {return fmt::to_string(os_uptime() / 60 % 60);}};
+    module_t os_uptime_h_module = {"hours", "uptime of the system in hours [34]", {}, [](unused) {return fmt::to_string(os_uptime() / (60 * 60) % 24);}};
+    module_t os_uptime_d_module = {"days", "uptime of the system in days [2]", {}, [](unused) {return fmt::to_string(os_uptime() / (60 * 60 * 24));}};
     module_t os_uptime_module = {"uptime", "(auto) uptime of the system [36 mins, 3 hours, 23 days]", {
         std::move(os_uptime_s_module),
         std::move(os_uptime_m_module),
         std::move(os_uptime_h_module),
         std::move(os_uptime_d_module),
-    }, [=](unused) { return get_auto_uptime(uptime_days, uptime_hours % 24, uptime_mins % 60,
-                                                   uptime_secs % 60, config); }};
+    }, [&](unused) {
+        const unsigned long uptime_secs = os_uptime();
+        return get_auto_uptime(uptime_secs / (60 * 60 * 24), uptime_secs / (60 * 60) % 24, uptime_secs / 60 % 60,
+                               uptime_secs % 60, config); }};
 
     module_t os_hostname_module = {"hostname", "hostname of the OS [myMainPC]", {}, os_hostname};
 
@@ -352,16 +450,45 @@ void core_plugins_start(const Config& config)
         std::move(cpu_temp_K_module),
     }, [](unused) {return fmt::format("{:.2f}°C", cpu_temp());}};
 
+    module_t cpu_usage_total_module = {"total", "CPU usage percentage of all cores [12.34]", {}, cpu_usage_total};
+    module_t cpu_usage_core_module = {"core", "CPU usage percentage of a single core [$<cpu.usage.core(0)> = 23.45]", {}, cpu_usage_core};
+    module_t cpu_usage_iowait_module = {"iowait", "percentage of CPU time spent waiting for I/O [0.52]", {}, cpu_usage_iowait};
+    module_t cpu_usage_steal_module = {"steal", "percentage of CPU time stolen by the hypervisor [0.00]", {}, cpu_usage_steal};
+    module_t cpu_usage_module = {"usage", "CPU usage percentage of all cores, colored [12.34%]", {
+        std::move(cpu_usage_total_module),
+        std::move(cpu_usage_core_module),
+        std::move(cpu_usage_iowait_module),
+        std::move(cpu_usage_steal_module),
+    }, cpu_usage_fmt};
+
     module_t cpu_module = {"cpu", "CPU model name with number of virtual processors and max freq [AMD Ryzen 5 5500 (12) @ 4.90 GHz]",{
         std::move(cpu_name_module),
         std::move(cpu_nproc_module),
         std::move(cpu_freq_module),
         std::move(cpu_temp_module),
+        std::move(cpu_usage_module),
     }, [](unused _) {
             return fmt::format("{} ({}) @ {} GHz", cpu_name(_), cpu_nproc(_), cpu_freq_max(_));
         }};
     cfRegisterModule(cpu_module);
 
+#if !CF_MACOS
+    // $<temp>
+    module_t temp_sensor_module = {"sensor", "temperature of a hwmon sensor, by chip name and optional label [$<temp.sensor(k10temp:Tctl)> = 45.25°C]", {}, temp_sensor};
+    module_t temp_core_module = {"core", "temperature of a CPU core, intel only [$<temp.core(0)> = 42.00°C]", {}, temp_core};
+    module_t temp_gpu_module = {"gpu", "temperature of the GPU (amdgpu, nouveau) [$<temp.gpu(0)> = 51.00°C]", {}, temp_gpu};
+    module_t temp_nvme_module = {"nvme", "temperature of a NVMe drive [$<temp.nvme(0)> = 38.85°C]", {}, temp_nvme};
+    module_t temp_max_module = {"max", "highest temperature between all the sensors [67.12°C]", {}, temp_max};
+    module_t temp_module = {"temp", "hardware temperatures from hwmon sensors (highest temperature) [67.12°C]", {
+        std::move(temp_sensor_module),
+        std::move(temp_core_module),
+        std::move(temp_gpu_module),
+        std::move(temp_nvme_module),
+        std::move(temp_max_module),
+    }, temp_max};
+    cfRegisterModule(temp_module);
+#endif
+
     // $<user>
     module_t user_name_module = {"name", "name you are currently logged in (not real name) [toni69]", {}, user_name};
 
@@ -462,16 +589,25 @@ void core_plugins_start(const Config& config)
     module_t battery_technology_module = {"technology", "battery technology [Li-lion]", {}, battery_technology};
     module_t battery_vendor_module = {"manufacturer", "battery manufacturer name", {}, battery_vendor};
     module_t battery_perc_module = {"perc", "battery current percentage", {}, battery_perc};
-
-    module_t battery_temp_C_module = {"C", "battery temperature in Celsius [e.g. 37.12°C]", {}, [](unused) {return fmt::format("{:.2f}°C", battery_temp());}};
-    module_t battery_temp_F_module = {"F", "battery temperature in Fahrenheit [e.g. 98.81°F]", {}, [](unused) {return fmt::format("{:.2f}°F", battery_temp() * 1.8 + 34);}};
-    module_t battery_temp_K_module = {"K", "battery temperature in Kelvin [e.g. 310.27°K]", {}, [](unused) {return fmt::format("{:.2f}°K", battery_temp() + 273.15);}};
+    module_t battery_cycles_module = {"cycles", "battery charge cycles count [156]", {}, battery_cycle_count};
+    module_t battery_energy_module = {"energy", "battery current energy [42.10 Wh]", {}, battery_energy_now};
+    module_t battery_power_module = {"power", "battery current power draw [8.25 W]", {}, battery_power_now};
+
+    module_t battery_total_perc_module = {"perc", "percentage of all the batteries combined", {}, battery_total_perc};
+    module_t battery_total_module = {"total", "percentage of all the batteries combined, weighted by their energy [75.00%]", {
+        std::move(battery_total_perc_module),
+    }, battery_total_fmt};
+
+    module_t battery_temp_C_module = {"C", "battery temperature in Celsius [e.g. 37.12°C]", {}, [](const callbackInfo_t* callbackInfo) {return fmt::format("{:.2f}°C", battery_temp(callbackInfo));}};
+    module_t battery_temp_F_module = {"F", "battery temperature in Fahrenheit [e.g. 98.81°F]", {}, [](const callbackInfo_t* callbackInfo) {return fmt::format("{:.2f}°F", battery_temp(callbackInfo) * 1.8 + 34);}};
+    module_t battery_temp_K_module = {"K", "battery temperature in Kelvin [e.g. 310.27°K]", {}, [](const callbackInfo_t* callbackInfo) {return fmt::format("{:.2f}°K", battery_temp(callbackInfo) + 273.15);}};
     module_t battery_temp_module = {"temp", "battery temperature (by the chosen unit)", {
         std::move(battery_temp_C_module),
         std::move(battery_temp_F_module),
         std::move(battery_temp_K_module),
-    }, [](unused) {return fmt::format("{:.2f}°C", battery_temp());}};
+    }, [](const callbackInfo_t* callbackInfo) {return fmt::format("{:.2f}°C", battery_temp(callbackInfo));}};
 
+    // battery(N) queries the N-th battery found (starting from 0), e.g $<battery(1).perc>
     module_t battery_module = {"battery", "battery current percentage and status [50.00% [Discharging]]", {
         std::move(battery_modelname_module),
         std::move(battery_status_module),
@@ -480,6 +616,10 @@ void core_plugins_start(const Config& config)
         std::move(battery_vendor_module),
         std::move(battery_perc_module),
         std::move(battery_temp_module),
+        std::move(battery_cycles_module),
+        std::move(battery_energy_module),
+        std::move(battery_power_module),
+        std::move(battery_total_module),
     }, battery_fmt};
     cfRegisterModule(battery_module);
 
@@ -28,72 +28,201 @@
 
 #include <unistd.h>
 
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "core-modules.hh"
+#include "fmt/format.h"
 #include "libcufetch/common.hh"
 #include "util.hpp"
 
-static std::string read_strip_syspath(const std::string_view path)
+// Properties of a power supply, as read from its uevent file.
+// Keys are the same as the sysfs attribute files (e.g "capacity", "energy_now")
+using battery_t = std::unordered_map<std::string, std::string>;
+
+static battery_t read_uevent(const std::string& path)
 {
-    std::string str = read_by_syspath(path);
-    debug("str = {} || path = {}", str, path);
+    battery_t     battery;
+    std::ifstream f(path + "/uevent", std::ios::in);
+    if (!f.is_open())
+        return battery;
+
+    std::string line;
+    while (std::getline(f, line))
+    {
+        const size_t pos = line.find('=');
+        if (!hasStart(line, "POWER_SUPPLY_") || pos == line.npos)
+            continue;
 
-    // optimization
-    if (str.back() == '\n')
-        str.pop_back();
-    else if (str != UNKNOWN)
-        strip(str);
+        battery.emplace(str_tolower(line.substr("POWER_SUPPLY_"_len, pos - "POWER_SUPPLY_"_len)),
+                        line.substr(pos + 1));
+    }
 
-    return str;
+    return battery;
 }
 
-static std::string get_battery_info(const std::string& file)
+static const std::vector<battery_t>& get_batteries()
 {
-    if (access("/sys/class/power_supply/", F_OK) != 0)
-        return MAGIC_LINE;
-
-    for (const auto& dir_entry : std::filesystem::directory_iterator{ "/sys/class/power_supply/" })
+    static std::vector<battery_t>                batteries;
+    static std::chrono::steady_clock::time_point last_sweep;
+    static bool                                  done = false;
+
+    const auto now = std::chrono::steady_clock::now();
+    if (done && now - last_sweep < MODULE_SNAPSHOT_TTL)
+        return batteries;
+
+    done       = true;
+    last_sweep = now;
+    batteries.clear();
+
+    std::error_code          ec;
+    std::vector<std::string> paths;
+    for (const auto& dir_entry : std::filesystem::directory_iterator{ "/sys/class/power_supply/", ec })
+        paths.push_back(dir_entry.path().string());
+
+    // keep the same order across runs, so BAT0 comes before BAT1
+    std::sort(paths.begin(), paths.end());
+    for (const std::string& path : paths)
     {
-        const std::string& path = dir_entry.path().string() + "/";
         debug("battery path = {}", path);
-
-        const std::string& tmp = read_strip_syspath(path + "type");
-        if (tmp == UNKNOWN || tmp != "Battery")
-            continue;
-        if (read_strip_syspath(path + "scope") == "Device")
+        battery_t battery = read_uevent(path);
+        if (battery["type"] != "Battery" || battery["scope"] == "Device")
             continue;
 
         debug("battery found yeappyy");
-        return read_strip_syspath(path + file);
+        batteries.push_back(std::move(battery));
+    }
+
+    return batteries;
+}
+
+static std::string get_battery_info(const callbackInfo_t* callbackInfo, const std::string& key)
+{
+    // $<battery(1).perc> queries the second battery found, $<battery.perc> the first one.
+    const std::vector<battery_t>& batteries = get_batteries();
+    const size_t                  index     = get_module_index(callbackInfo, "battery");
+    if (index >= batteries.size())
+        return UNKNOWN;
+
+    const auto it = batteries[index].find(key);
+    if (it == batteries[index].end())
+        return UNKNOWN;
+
+    return it->second;
+}
+
+static double get_battery_value(const battery_t& battery, const std::string& key)
+{
+    const auto it = battery.find(key);
+    if (it == battery.end())
+        return 0;
+
+    try
+    {
+        return std::stod(it->second);
+    }
+    catch (const std::exception&)
+    {
+        return 0;
     }
+}
+
+// in µWh
+static double get_battery_energy(const battery_t& battery, const std::string_view which)
+{
+    const double energy = get_battery_value(battery, fmt::format("energy_{}", which));
+    if (energy > 0)
+        return energy;
 
-    return UNKNOWN;
+    // some batteries only expose the charge in µAh
+    return get_battery_value(battery, fmt::format("charge_{}", which)) *
+           get_battery_value(battery, "voltage_min_design") / 1000000;
 }
 
 // clang-format off
 MODFUNC(battery_modelname)
-{ return get_battery_info("model_name"); }
+{ return get_battery_info(callbackInfo, "model_name"); }
 
 MODFUNC(battery_perc)
-{ return get_battery_info("capacity"); }
+{ return get_battery_info(callbackInfo, "capacity"); }
 
 MODFUNC(battery_status)
-{ return get_battery_info("status"); }
+{ return get_battery_info(callbackInfo, "status"); }
 
 MODFUNC(battery_capacity_level)
-{ return get_battery_info("capacity_level"); }
+{ return get_battery_info(callbackInfo, "capacity_level"); }
 
 MODFUNC(battery_technology)
-{ return get_battery_info("technology"); }
+{ return get_battery_info(callbackInfo, "technology"); }
 
 MODFUNC(battery_vendor)
-{ return get_battery_info("manufacturer"); }
+{ return get_battery_info(callbackInfo, "manufacturer"); }
+
+MODFUNC(battery_cycle_count)
+{ return get_battery_info(callbackInfo, "cycle_count"); }
+// clang-format on
+
+MODFUNC(battery_energy_now)
+{
+    const std::vector<battery_t>& batteries = get_batteries();
+    const size_t                  index     = get_module_index(callbackInfo, "battery");
+    if (index >= batteries.size())
+        return UNKNOWN;
+
+    const double energy = get_battery_energy(batteries[index], "now");
+    if (energy <= 0)
+        return UNKNOWN;
+
+    return fmt::format("{:.2f} Wh", energy / 1000000);
+}
+
+MODFUNC(battery_power_now)
+{
+    const std::vector<battery_t>& batteries = get_batteries();
+    const size_t                  index     = get_module_index(callbackInfo, "battery");
+    if (index >= batteries.size())
+        return UNKNOWN;
+
+    const battery_t& battery = batteries[index];
+    double           power   = get_battery_value(battery, "power_now");
+    if (power <= 0)
+        power = get_battery_value(battery, "current_now") * get_battery_value(battery, "voltage_now") / 1000000;
+    if (power <= 0)
+        return UNKNOWN;
+
+    return fmt::format("{:.2f} W", power / 1000000);
+}
+
+MODFUNC(battery_total_perc)
+{
+    const std::vector<battery_t>& batteries = get_batteries();
+    if (batteries.empty())
+        return UNKNOWN;
+
+    // weight each battery by its energy, so a small UPS battery doesn't count as much as the laptop one
+    double now = 0, full = 0, capacity = 0;
+    for (const battery_t& battery : batteries)
+    {
+        now += get_battery_energy(battery, "now");
+        full += get_battery_energy(battery, "full");
+        capacity += get_battery_value(battery, "capacity");
+    }
+
+    if (full > 0)
+        return fmt::format("{:.2f}", std::min(now * 100 / full, 100.0));
+
+    return fmt::format("{:.2f}", capacity / batteries.size());
+}
 
-double battery_temp()
+double battery_temp(const callbackInfo_t* callbackInfo)
 {
-    const std::string& temp = get_battery_info("temp");
-    if (temp != UNKNOWN || temp != MAGIC_LINE)
+    const std::string& temp = get_battery_info(callbackInfo, "temp");
+    if (temp != UNKNOWN && temp != MAGIC_LINE)
         return std::stod(temp) / 10;
 
     return 0;
@@ -1,15 +1,23 @@
 #include "platform.hpp"
 #if CF_ANDROID || CF_LINUX
+#include <fcntl.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
 #include <cstring>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "core-modules.hh"
 #include "fmt/format.h"
 #include "libcufetch/common.hh"
 #include "switch_fnv1a.hpp"
 #include "util.hpp"
+#include "utils/hwmon.hh"
 
 const std::string freq_dir = "/sys/devices/system/cpu/cpu0/cpufreq";
 
@@ -518,27 +526,158 @@ static bool read_value(const char* name, size_t n, bool do_rewind, char* buf, si
 
 float cpu_temp()
 {
-    for (const auto& dir : std::filesystem::directory_iterator{ "/sys/class/hwmon/" })
+    for (const std::string_view chip : { "cpu", "k10temp", "coretemp", "zenpower" })
     {
-        const std::string& name = read_by_syspath((dir.path() / "name").string());
-        debug("name = {}", name);
-        if (name != "cpu" && name != "k10temp" && name != "coretemp")
+        const hwmon_sensor_t* sensor = hwmon_find_sensor(chip);
+        if (!sensor)
             continue;
 
-        const std::string& temp_file = (access((dir.path() / "temp1_input").string().c_str(), F_OK) != 0)
-                                           ? dir.path() / "device/temp1_input"
-                                           : dir.path() / "temp1_input";
-        if (access(temp_file.c_str(), F_OK) != 0)
-            continue;
-
-        const float ret = std::stof(read_by_syspath(temp_file));
+        const double ret = hwmon_read_temp(*sensor);
         debug("cpu temp ret = {}", ret);
-
-        return ret / 1000.0f;
+        if (!std::isnan(ret))
+            return ret;
     }
     return 0.0f;
 }
 
+// Times spent by a CPU (or all of them) in each state, from /proc/stat
+struct cpu_times_t
+{
+    long                         id = -1;  // -1 = aggregate "cpu" line
+    std::array<std::uint64_t, 8> times{};  // user nice system idle iowait irq softirq steal
+};
+
+enum
+{
+    CPU_TIME_IDLE   = 3,
+    CPU_TIME_IOWAIT = 4,
+    CPU_TIME_STEAL  = 7
+};
+
+static std::vector<cpu_times_t> read_proc_stat()
+{
+    static int fd = open("/proc/stat", O_RDONLY | O_CLOEXEC);
+
+    std::vector<cpu_times_t> ret;
+    if (fd < 0)
+        return ret;
+
+    // the cpu lines are at the start of the file, stop reading once we got past them
+    std::string buf;
+    size_t      len = 0;
+    while (true)
+    {
+        buf.resize(len + 16384);
+        const ssize_t n = pread(fd, &buf[len], 16384, len);
+        if (n <= 0)
+            break;
+        len += n;
+        buf.resize(len);
+        if (buf.find("\nintr") != buf.npos || buf.find("\nctxt") != buf.npos)
+            break;
+    }
+    buf.resize(len);
+
+    const char* p   = buf.c_str();
+    const char* end = p + buf.length();
+    while (p < end && strncmp(p, "cpu", "cpu"_len) == 0)
+    {
+        cpu_times_t cpu;
+        char*       next = const_cast<char*>(p + "cpu"_len);
+        if (*next != ' ')
+            cpu.id = std::strtol(next, &next, 10);
+
+        for (std::uint64_t& time : cpu.times)
+            time = std::strtoull(next, &next, 10);
+
+        ret.push_back(cpu);
+        p = strchr(next, '\n');
+        if (!p)
+            break;
+        ++p;
+    }
+
+    return ret;
+}
+
+// Get the samples to calculate the CPU usage.
+// The first time we need to wait a bit to have two samples to compare,
+// then (in live mode) the previous render sample is used.
+static const std::pair<std::vector<cpu_times_t>, std::vector<cpu_times_t>>& get_cpu_samples()
+{
+    static std::pair<std::vector<cpu_times_t>, std::vector<cpu_times_t>> samples;  // [previous, current]
+    static std::chrono::steady_clock::time_point                          last_sample;
+
+    if (samples.second.empty())
+    {
+        samples.first = read_proc_stat();
+        std::this_thread::sleep_for(std::chrono::milliseconds(cpu_usage_first_sample_ms));
+        samples.second = read_proc_stat();
+        last_sample    = std::chrono::steady_clock::now();
+    }
+    else if (std::chrono::steady_clock::now() - last_sample >= MODULE_SNAPSHOT_TTL)
+    {
+        samples.first  = std::move(samples.second);
+        samples.second = read_proc_stat();
+        last_sample    = std::chrono::steady_clock::now();
+    }
+
+    return samples;
+}
+
+/* Get the percentage of time a CPU spent in a state between the two samples
+ * @param id The CPU number (-1 for all of them)
+ * @param state The state index in cpu_times_t::times (-1 for busy, aka not idle)
+ */
+static std::string get_cpu_usage(const long id, const int state)
+{
+    const auto& [prev, cur] = get_cpu_samples();
+
+    const auto find = [id](const std::vector<cpu_times_t>& sample) -> const cpu_times_t* {
+        for (const cpu_times_t& cpu : sample)
+            if (cpu.id == id)
+                return &cpu;
+        return nullptr;
+    };
+
+    const cpu_times_t* a = find(prev);
+    const cpu_times_t* b = find(cur);
+    if (!a || !b)
+        return UNKNOWN;
+
+    // some counters (e.g iowait) can go backwards, don't let them wrap around
+    const auto diff = [a, b](const size_t i) -> std::uint64_t {
+        return (b->times[i] > a->times[i]) ? b->times[i] - a->times[i] : 0;
+    };
+
+    std::uint64_t total = 0, idle = 0, delta = 0;
+    for (size_t i = 0; i < b->times.size(); ++i)
+        total += diff(i);
+    idle = diff(CPU_TIME_IDLE) + diff(CPU_TIME_IOWAIT);
+    if (total == 0)
+        return "0.00";
+
+    delta = (state < 0) ? total - idle : diff(state);
+    return fmt::format("{:.2f}", static_cast<double>(delta) * 100 / total);
+}
+
+MODFUNC(cpu_usage_total)
+{ return get_cpu_usage(-1, -1); }
+
+MODFUNC(cpu_usage_iowait)
+{ return get_cpu_usage(-1, CPU_TIME_IOWAIT); }
+
+MODFUNC(cpu_usage_steal)
+{ return get_cpu_usage(-1, CPU_TIME_STEAL); }
+
+MODFUNC(cpu_usage_core)
+{
+    if (get_module_arg(callbackInfo, "core").empty())
+        die("Module cpu.usage.core doesn't have an argument to the CPU number to query (e.g $<cpu.usage.core(0)>)");
+
+    return get_cpu_usage(get_module_index(callbackInfo, "cpu.usage.core"), -1);
+}
+
 #if CF_ANDROID
 MODFUNC(android_cpu_model_name)
 { return get_android_property("ro.soc.model"); }
@@ -47,17 +47,18 @@ static std::string read_value(const std::string_view name)
     return result;
 }
 
+// called at every live mode tick, so avoid opening /proc/uptime when possible
 unsigned long os_uptime()
 {
+    struct std::timespec uptime;
+    if (clock_gettime(CLOCK_BOOTTIME, &uptime) == 0)
+        return uptime.tv_sec;
+
     const std::string& buf = read_by_syspath("/proc/uptime");
     if (buf != UNKNOWN)
         return std::stoul(buf.substr(0, buf.find('.')));  // 19065.18 190952.06
 
-    struct std::timespec uptime;
-    if (clock_gettime(CLOCK_BOOTTIME, &uptime) != 0)
-        return 0;
-
-    return (unsigned long)uptime.tv_sec * 1000 + (unsigned long)uptime.tv_nsec / 1000000;
+    return 0;
 }
 
 MODFUNC(os_name)
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2025 Toni500git
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "platform.hpp"
+#if CF_LINUX || CF_ANDROID
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "core-modules.hh"
+#include "fmt/format.h"
+#include "libcufetch/common.hh"
+#include "util.hpp"
+#include "utils/hwmon.hh"
+
+// Some drivers report placeholders like 127°C or -128°C for sensors not connected
+static bool is_valid_temp(const double temp)
+{ return !std::isnan(temp) && temp > -40 && temp < 127; }
+
+static std::string format_temp(const hwmon_sensor_t* sensor)
+{
+    if (!sensor)
+        return UNKNOWN;
+
+    const double temp = hwmon_read_temp(*sensor);
+    if (!is_valid_temp(temp))
+        return UNKNOWN;
+
+    return fmt::format("{:.2f}°C", temp);
+}
+
+// $<temp.sensor(k10temp)> or $<temp.sensor(k10temp:Tccd1)>
+MODFUNC(temp_sensor)
+{
+    const std::string& value = get_module_arg(callbackInfo, "sensor");
+    if (value.empty())
+        die("Module temp.sensor doesn't have an argument to the sensor to query (e.g $<temp.sensor(k10temp:Tctl)>)");
+
+    const size_t pos = value.find(':');
+    if (pos == value.npos)
+        return format_temp(hwmon_find_sensor(value));
+
+    return format_temp(hwmon_find_sensor(value.substr(0, pos), value.substr(pos + 1)));
+}
+
+MODFUNC(temp_core)
+{
+    const std::string& label = fmt::format("Core {}", get_module_index(callbackInfo, "temp.core"));
+    return format_temp(hwmon_find_sensor("coretemp", label));
+}
+
+MODFUNC(temp_gpu)
+{
+    const size_t index = get_module_index(callbackInfo, "temp.gpu");
+
+    const hwmon_sensor_t* sensor = hwmon_find_sensor("amdgpu", "edge", index);
+    if (!sensor)
+        sensor = hwmon_find_sensor("amdgpu", "", index);
+    if (!sensor)
+        sensor = hwmon_find_sensor("nouveau", "", index);
+
+    return format_temp(sensor);
+}
+
+MODFUNC(temp_nvme)
+{
+    const size_t index = get_module_index(callbackInfo, "temp.nvme");
+
+    const hwmon_sensor_t* sensor = hwmon_find_sensor("nvme", "Composite", index);
+    if (!sensor)
+        sensor = hwmon_find_sensor("nvme", "", index);
+
+    return format_temp(sensor);
+}
+
+MODFUNC(temp_max)
+{
+    double max = NAN;
+    for (const hwmon_sensor_t& sensor : hwmon_get_sensors())
+    {
+        const double temp = hwmon_read_temp(sensor);
+        if (is_valid_temp(temp) && (std::isnan(max) || temp > max))
+            max = temp;
+    }
+
+    if (std::isnan(max))
+        return UNKNOWN;
+
+    return fmt::format("{:.2f}°C", max);
+}
+
+#endif
@@ -26,25 +26,30 @@
 #include "platform.hpp"
 #if CF_LINUX
 
+#include <sys/stat.h>
+
 #include <algorithm>
 #include <array>
 #include <cstdint>
 #include <fstream>
 #include <functional>
+#include <unordered_map>
 
 #include "core-modules.hh"
 #include "fmt/format.h"
 #include "rapidxml-1.13/rapidxml.hpp"
 #include "switch_fnv1a.hpp"
 #include "util.hpp"
+#include "utils/gvdb.hh"
 
 #if USE_DCONF
 #include <client/dconf-client.h>
 #include <glib/gvariant.h>
 #endif
 
-using ThemeInfo  = std::array<std::string, 3>;  // [theme, icon_theme, font]
-using CursorInfo = std::array<std::string, 2>;  // [name, size]
+using ThemeInfo     = std::array<std::string, 3>;  // [theme, icon_theme, font]
+using CursorInfo    = std::array<std::string, 2>;  // [name, size]
+using InterfaceInfo = std::array<std::string, 5>;  // [theme, icon_theme, font, cursor, cursor_size]
 
 enum
 {
@@ -59,6 +64,10 @@ enum
     CURSOR_SIZE
 };
 
+// keys of the desktop interface schema, in the same order of InterfaceInfo
+constexpr std::array<std::string_view, 5> interface_keys = { "gtk-theme", "icon-theme", "font-name", "cursor-theme",
+                                                             "cursor-size" };
+
 const std::string& configDir          = getHomeConfigDir();
 const std::string  gsetting_interface = (user_de_name(NULL) == "cinnamon") ? "org.cinnamon.desktop.interface"
                                         : (de_name == "mate")              ? "org.mate.interface"
@@ -144,6 +153,214 @@ static std::string get_auto_gtk_format(const std::string_view gtk2, const std::s
     return MAGIC_LINE;
 }
 
+#if USE_DCONF
+static void read_interface_dconf(InterfaceInfo& info)
+{
+    // keep the library and the client around for the whole process,
+    // creating a new client at each read is what takes most of the time
+    static void*        handle = nullptr;
+    static DConfClient* client = nullptr;
+    static bool         tried  = false;
+
+    static GVariant* (*dconf_client_read)(DConfClient*, const char*) = nullptr;
+    static const gchar* (*g_variant_get_string)(GVariant*, gsize*)  = nullptr;
+    static const GVariantType* (*g_variant_get_type)(GVariant*)     = nullptr;
+    static gint32 (*g_variant_get_int32)(GVariant*)                 = nullptr;
+    static void (*g_variant_unref)(GVariant*)                       = nullptr;
+
+    if (!tried)
+    {
+        tried  = true;
+        handle = LOAD_LIBRARY("libdconf.so");
+        if (!handle)
+            handle = LOAD_LIBRARY("libdconf.so.1");
+        if (!handle)
+            return;
+
+        LOAD_LIB_SYMBOL(handle, DConfClient*, dconf_client_new, void);
+        dconf_client_read    = reinterpret_cast<decltype(dconf_client_read)>(dlsym(handle, "dconf_client_read"));
+        g_variant_get_string = reinterpret_cast<decltype(g_variant_get_string)>(dlsym(handle, "g_variant_get_string"));
+        g_variant_get_type   = reinterpret_cast<decltype(g_variant_get_type)>(dlsym(handle, "g_variant_get_type"));
+        g_variant_get_int32  = reinterpret_cast<decltype(g_variant_get_int32)>(dlsym(handle, "g_variant_get_int32"));
+        g_variant_unref      = reinterpret_cast<decltype(g_variant_unref)>(dlsym(handle, "g_variant_unref"));
+        if (!dconf_client_new || !dconf_client_read || !g_variant_get_string || !g_variant_get_type ||
+            !g_variant_get_int32 || !g_variant_unref)
+        {
+            UNLOAD_LIBRARY(handle);
+            handle = nullptr;
+            return;
+        }
+
+        client = dconf_client_new();
+    }
+
+    if (!client)
+        return;
+
+    debug("calling {}", __PRETTY_FUNCTION__);
+    for (size_t i = 0; i < interface_keys.size(); ++i)
+    {
+        GVariant* variant = dconf_client_read(client, fmt::format("{}/{}", dconf_interface, interface_keys[i]).c_str());
+        if (!variant)
+            continue;
+
+        const char* type = reinterpret_cast<const char*>(g_variant_get_type(variant));
+        if (type[0] == 's')
+            info[i] = g_variant_get_string(variant, NULL);
+        else if (type[0] == 'i')
+            info[i] = fmt::to_string(g_variant_get_int32(variant));
+
+        g_variant_unref(variant);
+    }
+}
+#endif
+
+// Parse `gsettings list-recursively` output, which gives us every key of the schema
+// (including the defaults) with only one process spawn.
+// e.g "org.gnome.desktop.interface gtk-theme 'Adwaita'"
+static void read_interface_gsettings(InterfaceInfo& info)
+{
+    std::string output;
+    read_exec({ "gsettings", "list-recursively", gsetting_interface.c_str() }, output);
+
+    std::string_view view = output;
+    while (!view.empty())
+    {
+        const size_t     eol  = view.find('\n');
+        std::string_view line = view.substr(0, eol);
+        view.remove_prefix(eol == view.npos ? view.size() : eol + 1);
+
+        const size_t key_start = line.find(' ');
+        if (key_start == line.npos)
+            continue;
+        line.remove_prefix(key_start + 1);
+
+        const size_t key_end = line.find(' ');
+        if (key_end == line.npos)
+            continue;
+
+        const std::string_view key = line.substr(0, key_end);
+        const auto             it  = std::find(interface_keys.begin(), interface_keys.end(), key);
+        if (it == interface_keys.end())
+            continue;
+
+        std::string& value = info[std::distance(interface_keys.begin(), it)];
+        if (value != MAGIC_LINE)
+            continue;
+
+        value = line.substr(key_end + 1);
+        value.erase(std::remove(value.begin(), value.end(), '\''), value.end());
+        if (value.empty())
+            value = MAGIC_LINE;
+    }
+}
+
+// Read all the keys we need from the desktop interface schema at once.
+// Tries in order: libdconf, the dconf user database (parsed directly), gsettings (only for the missing keys).
+// Results are cached and re-read only when the dconf database changes.
+static const InterfaceInfo& get_interface_settings()
+{
+    static InterfaceInfo   info;
+    static bool            done       = false;
+    static struct timespec last_mtime = {};
+
+    const std::string& db_path = configDir + "/dconf/user";
+    struct stat        st{};
+    const bool         has_db = stat(db_path.c_str(), &st) == 0;
+    if (done && (!has_db || (st.st_mtim.tv_sec == last_mtime.tv_sec && st.st_mtim.tv_nsec == last_mtime.tv_nsec)))
+        return info;
+
+    done       = true;
+    last_mtime = st.st_mtim;
+    info.fill(MAGIC_LINE);
+
+#if USE_DCONF
+    read_interface_dconf(info);
+#endif
+
+    if (has_db && std::find(info.begin(), info.end(), MAGIC_LINE) != info.end())
+    {
+        std::vector<std::string> keys, values;
+        for (const std::string_view key : interface_keys)
+            keys.push_back(fmt::format("{}/{}", dconf_interface, key));
+
+        debug("reading dconf database {}", db_path);
+        if (gvdb_read_keys(db_path, keys, values))
+        {
+            for (size_t i = 0; i < info.size(); ++i)
+                if (info[i] == MAGIC_LINE && !values[i].empty())
+                    info[i] = values[i];
+        }
+    }
+
+    if (std::find(info.begin(), info.end(), MAGIC_LINE) != info.end())
+        read_interface_gsettings(info);
+
+    return info;
+}
+
+// Parsed key/value snapshot of a GTK settings.ini/gtkrc file,
+// shared between all theme modules and re-parsed only when the file mtime changes.
+static const std::unordered_map<std::string, std::string>& get_gtk_config_keys(const std::string& path)
+{
+    struct gtk_config_t
+    {
+        struct timespec                              mtime{};
+        std::unordered_map<std::string, std::string> keys;
+    };
+    static std::unordered_map<std::string, gtk_config_t>      cache;
+    static const std::unordered_map<std::string, std::string> empty;
+
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+    {
+        cache.erase(path);
+        return empty;
+    }
+
+    const auto it = cache.find(path);
+    if (it != cache.end() && it->second.mtime.tv_sec == st.st_mtim.tv_sec &&
+        it->second.mtime.tv_nsec == st.st_mtim.tv_nsec)
+        return it->second.keys;
+
+    gtk_config_t& config = cache[path];
+    config.mtime         = st.st_mtim;
+    config.keys.clear();
+
+    std::ifstream f(path, std::ios::in);
+    if (!f.is_open())
+        return config.keys;
+
+    debug("parsing gtk config {}", path);
+    std::string line;
+    while (std::getline(f, line))
+    {
+        const size_t pos = line.find('=');
+        if (pos == line.npos || line[0] == '#' || line[0] == '[')
+            continue;
+
+        std::string key = line.substr(0, pos);
+        strip(key);
+        if (config.keys.find(key) != config.keys.end())
+            continue;
+
+        std::string value = line.substr(pos + 1);
+        value.erase(std::remove(value.begin(), value.end(), '\"'), value.end());
+        value.erase(std::remove(value.begin(), value.end(), '\''), value.end());
+        strip(value);
+        config.keys.emplace(std::move(key), std::move(value));
+    }
+
+    return config.keys;
+}
+
+static std::string get_gtk_config_value(const std::unordered_map<std::string, std::string>& keys,
+                                        const std::string& key)
+{
+    const auto it = keys.find(key);
+    return it != keys.end() ? it->second : MAGIC_LINE;
+}
+
 //
 //
 // 1. Cursor
@@ -176,74 +393,16 @@ static CursorInfo get_cursor_xresources()
     return { cursor_name, cursor_size };
 }
 
-static CursorInfo get_cursor_dconf()
-{
-    std::string cursor{ MAGIC_LINE }, cursor_size{ MAGIC_LINE };
-#if USE_DCONF
-    void* handle = LOAD_LIBRARY("libdconf.so");
-    if (!handle)
-        return { MAGIC_LINE, MAGIC_LINE };
-
-    LOAD_LIB_SYMBOL(handle, DConfClient*, dconf_client_new, void);
-    LOAD_LIB_SYMBOL(handle, GVariant*, dconf_client_read, DConfClient*, const char*);
-    LOAD_LIB_SYMBOL(handle, const gchar*, g_variant_get_string, GVariant*, gsize*);
-    LOAD_LIB_SYMBOL(handle, gint32, g_variant_get_int32, GVariant*);
-
-    debug("calling {}", __PRETTY_FUNCTION__);
-    DConfClient* client = dconf_client_new();
-    GVariant*    variant;
-
-    variant = dconf_client_read(client, (dconf_interface + "cursor-theme").c_str());
-    if (variant)
-        cursor = g_variant_get_string(variant, NULL);
-
-    variant = dconf_client_read(client, (dconf_interface + "cursor-size").c_str());
-    if (variant)
-        cursor_size = fmt::to_string(g_variant_get_int32(variant));
-#endif
-    return { cursor, cursor_size };
-}
-
 static CursorInfo get_cursor_gsettings()
 {
-    const CursorInfo& dconf = get_cursor_dconf();
-    if (dconf != CursorInfo{ MAGIC_LINE, MAGIC_LINE })
-        return dconf;
-
-    std::string cursor;
-    read_exec({ "gsettings", "get", gsetting_interface.c_str(), "cursor-theme" }, cursor);
-    cursor.erase(std::remove(cursor.begin(), cursor.end(), '\''), cursor.end());
-
-    std::string cursor_size;
-    read_exec({ "gsettings", "get", gsetting_interface.c_str(), "cursor-size" }, cursor_size);
-    cursor_size.erase(std::remove(cursor_size.begin(), cursor_size.end(), '\''), cursor_size.end());
-
-    if (cursor.empty())
-        cursor = MAGIC_LINE;
-    if (cursor_size.empty())
-        cursor_size = MAGIC_LINE;
-    return { cursor, cursor_size };
+    const InterfaceInfo& info = get_interface_settings();
+    return { info[3], info[4] };
 }
 
-static CursorInfo get_gtk_cursor_config(const std::string_view path)
+static CursorInfo get_gtk_cursor_config(const std::string& path)
 {
-    std::string   cursor{ MAGIC_LINE }, cursor_size{ MAGIC_LINE };
-    std::ifstream f(path.data(), std::ios::in);
-    if (!f.is_open())
-        return { cursor, cursor_size };
-
-    std::string   line;
-    std::uint16_t iter_index = 0;
-    while (std::getline(f, line) && iter_index < 2)
-    {
-        if (hasStart(line, "gtk-cursor-theme-name="))
-            getFileValue(iter_index, line, cursor, "gtk-cursor-theme-name="_len);
-
-        else if (hasStart(line, "gtk-cursor-theme-size="))
-            getFileValue(iter_index, line, cursor_size, "gtk-cursor-theme-size="_len);
-    }
-
-    return { cursor, cursor_size };
+    const auto& keys = get_gtk_config_keys(path);
+    return { get_gtk_config_value(keys, "gtk-cursor-theme-name"), get_gtk_config_value(keys, "gtk-cursor-theme-size") };
 }
 
 static CursorInfo get_cursor_from_gtk_configs(const std::uint8_t ver)
@@ -282,86 +441,17 @@ static CursorInfo get_de_cursor(const std::string_view de_name)
 //
 // 2. GTK theme
 //
-static ThemeInfo get_gtk_theme_config(const std::string_view path)
+static ThemeInfo get_gtk_theme_config(const std::string& path)
 {
-    std::string   theme{ MAGIC_LINE }, icon_theme{ MAGIC_LINE }, font{ MAGIC_LINE };
-    std::ifstream f(path.data(), std::ios::in);
-    if (!f.is_open())
-        return { theme, icon_theme, font };
-
-    std::string   line;
-    std::uint16_t iter_index = 0;
-    while (std::getline(f, line) && iter_index < 3)
-    {
-        if (hasStart(line, "gtk-theme-name="))
-            getFileValue(iter_index, line, theme, "gtk-theme-name="_len);
-
-        else if (hasStart(line, "gtk-icon-theme-name="))
-            getFileValue(iter_index, line, icon_theme, "gtk-icon-theme-name="_len);
-
-        else if (hasStart(line, "gtk-font-name="))
-            getFileValue(iter_index, line, font, "gtk-font-name="_len);
-    }
-
-    return { theme, icon_theme, font };
-}
-
-static ThemeInfo get_gtk_theme_dconf()
-{
-    std::string theme{ MAGIC_LINE }, icon_theme{ MAGIC_LINE }, font{ MAGIC_LINE };
-#if USE_DCONF
-    void* handle = LOAD_LIBRARY("libdconf.so");
-    if (!handle)
-        return { theme, icon_theme, font };
-
-    LOAD_LIB_SYMBOL(handle, DConfClient*, dconf_client_new, void);
-    LOAD_LIB_SYMBOL(handle, GVariant*, dconf_client_read, DConfClient * client, const char*);
-    LOAD_LIB_SYMBOL(handle, const gchar*, g_variant_get_string, GVariant* value, gsize* lenght);
-
-    debug("calling {}", __PRETTY_FUNCTION__);
-    DConfClient* client = dconf_client_new();
-    GVariant*    variant;
-
-    variant = dconf_client_read(client, (dconf_interface + "gtk-theme").c_str());
-    if (variant)
-        theme = g_variant_get_string(variant, NULL);
-
-    variant = dconf_client_read(client, (dconf_interface + "icon-theme").c_str());
-    if (variant)
-        icon_theme = g_variant_get_string(variant, NULL);
-
-    variant = dconf_client_read(client, (dconf_interface + "font-name").c_str());
-    if (variant)
-        font = g_variant_get_string(variant, NULL);
-
-#endif
-    return { theme, icon_theme, font };
+    const auto& keys = get_gtk_config_keys(path);
+    return { get_gtk_config_value(keys, "gtk-theme-name"), get_gtk_config_value(keys, "gtk-icon-theme-name"),
+             get_gtk_config_value(keys, "gtk-font-name") };
 }
 
 static ThemeInfo get_gtk_theme_gsettings()
 {
-    const ThemeInfo& dconf = get_gtk_theme_dconf();
-    if (dconf != ThemeInfo{ MAGIC_LINE, MAGIC_LINE, MAGIC_LINE })
-        return dconf;
-
-    std::string theme, icon_theme, font;
-
-    read_exec({ "gsettings", "get", gsetting_interface.c_str(), "gtk-theme" }, theme);
-    theme.erase(std::remove(theme.begin(), theme.end(), '\''), theme.end());
-
-    read_exec({ "gsettings", "get", gsetting_interface.c_str(), "icon-theme" }, icon_theme);
-    icon_theme.erase(std::remove(icon_theme.begin(), icon_theme.end(), '\''), icon_theme.end());
-
-    read_exec({ "gsettings", "get", gsetting_interface.c_str(), "font-name" }, font);
-    font.erase(std::remove(font.begin(), font.end(), '\''), font.end());
-
-    if (theme.empty())
-        theme = MAGIC_LINE;
-    if (icon_theme.empty())
-        icon_theme = MAGIC_LINE;
-    if (font.empty())
-        font = MAGIC_LINE;
-    return { theme, icon_theme, font };
+    const InterfaceInfo& info = get_interface_settings();
+    return { info[0], info[1], info[2] };
 }
 
 static ThemeInfo get_gtk_theme_from_configs(const std::uint8_t ver)
@@ -33,6 +33,7 @@
 #include "core-modules.hh"
 #include "fmt/format.h"
 #include "libcufetch/common.hh"
+#include "profile.hpp"
 #include "switch_fnv1a.hpp"
 #include "tiny-process-library/process.hpp"
 #include "util.hpp"
@@ -110,6 +111,7 @@ MODFUNC(user_shell_version)
     const std::string& shell_name = user_shell_name(callbackInfo);
     std::string        ret;
 
+    Profile::record_spawn(shell_name);
     if (shell_name == "nu")
         Process("nu -c \"version | get version\"", "", [&](const char* bytes, size_t n) { ret.assign(bytes, n); });
     else
@@ -0,0 +1,257 @@
+/*
+ * Copyright 2025 Toni500git
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Minimal read-only implementation of the GVDB format.
+// https://gitlab.gnome.org/GNOME/gvdb/-/blob/main/gvdb/gvdb-format.h
+
+#include "gvdb.hh"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "fmt/format.h"
+
+constexpr std::uint32_t GVDB_SIGNATURE0 = 1918981703;  // "GVar"
+constexpr std::uint32_t GVDB_SIGNATURE1 = 1953390953;  // "iant"
+
+struct gvdb_ctx_t
+{
+    std::string_view data;
+    bool             byteswapped = false;
+
+    // items of the root hash table
+    std::uint32_t n_buckets   = 0;
+    std::uint32_t buckets     = 0;  // offset of the buckets array
+    std::uint32_t items       = 0;  // offset of the hash items array
+    std::uint32_t n_items     = 0;
+};
+
+// struct gvdb_hash_item
+struct gvdb_item_t
+{
+    std::uint32_t hash_value;
+    std::uint32_t parent;
+    std::uint32_t key_start;
+    std::uint16_t key_size;
+    char          type;
+    std::uint32_t value_start;
+    std::uint32_t value_end;
+};
+
+constexpr std::uint32_t GVDB_ITEM_SIZE = 24;
+
+static std::uint16_t swap16(const std::uint16_t n)
+{ return (n >> 8) | (n << 8); }
+
+static std::uint32_t swap32(const std::uint32_t n)
+{ return ((n >> 24) & 0xff) | ((n >> 8) & 0xff00) | ((n << 8) & 0xff0000) | (n << 24); }
+
+static std::uint32_t read_u32(const gvdb_ctx_t& ctx, const std::uint32_t offset)
+{
+    std::uint32_t n;
+    std::memcpy(&n, ctx.data.data() + offset, sizeof(n));
+    return ctx.byteswapped ? swap32(n) : n;
+}
+
+static std::uint16_t read_u16(const gvdb_ctx_t& ctx, const std::uint32_t offset)
+{
+    std::uint16_t n;
+    std::memcpy(&n, ctx.data.data() + offset, sizeof(n));
+    return ctx.byteswapped ? swap16(n) : n;
+}
+
+static gvdb_item_t read_item(const gvdb_ctx_t& ctx, const std::uint32_t index)
+{
+    const std::uint32_t off = ctx.items + index * GVDB_ITEM_SIZE;
+
+    gvdb_item_t item;
+    item.hash_value  = read_u32(ctx, off);
+    item.parent      = read_u32(ctx, off + 4);
+    item.key_start   = read_u32(ctx, off + 8);
+    item.key_size    = read_u16(ctx, off + 12);
+    item.type        = ctx.data[off + 14];
+    item.value_start = read_u32(ctx, off + 16);
+    item.value_end   = read_u32(ctx, off + 20);
+    return item;
+}
+
+// djb2 hash, the same used by gvdb when writing the table
+static std::uint32_t gvdb_hash(const std::string_view key)
+{
+    std::uint32_t hash = 5381;
+    for (const char c : key)
+        hash = (hash * 33) + static_cast<signed char>(c);
+
+    return hash;
+}
+
+// Each item only stores the last part of the key, and the rest of it is in its parents.
+// e.g "/org/gnome/" -> "desktop/" -> "interface/" -> "gtk-theme"
+static bool check_key(const gvdb_ctx_t& ctx, const gvdb_item_t& item, std::string_view key, std::uint8_t depth = 0)
+{
+    if (depth > 64 || item.key_size > key.length() ||
+        static_cast<std::uint64_t>(item.key_start) + item.key_size > ctx.data.size())
+        return false;
+
+    if (ctx.data.substr(item.key_start, item.key_size) != key.substr(key.length() - item.key_size))
+        return false;
+
+    key.remove_suffix(item.key_size);
+    if (item.parent == 0xffffffff)
+        return key.empty();
+
+    if (item.parent >= ctx.n_items || key.empty())
+        return false;
+
+    return check_key(ctx, read_item(ctx, item.parent), key, depth + 1);
+}
+
+// Convert a serialized GVariant of type "v" into a string
+// It's the child value, then a NUL byte and then the type string of the child.
+static bool variant_to_string(const gvdb_ctx_t& ctx, const std::string_view blob, std::string& ret)
+{
+    const size_t sep = blob.rfind('\0');
+    if (sep == blob.npos)
+        return false;
+
+    const std::string_view type  = blob.substr(sep + 1);
+    const std::string_view value = blob.substr(0, sep);
+    if (type.length() != 1)
+        return false;
+
+    std::uint32_t n = 0;
+    switch (type[0])
+    {
+        case 's':
+            if (value.empty() || value.back() != '\0')
+                return false;
+            ret.assign(value.data(), value.length() - 1);
+            return true;
+
+        case 'b':
+            if (value.length() != 1)
+                return false;
+            ret = value[0] ? "true" : "false";
+            return true;
+
+        case 'i':
+        case 'u':
+            if (value.length() != sizeof(n))
+                return false;
+            std::memcpy(&n, value.data(), sizeof(n));
+            if (ctx.byteswapped)
+                n = swap32(n);
+            ret = (type[0] == 'i') ? fmt::to_string(static_cast<std::int32_t>(n)) : fmt::to_string(n);
+            return true;
+
+        case 'd':
+        {
+            std::uint64_t d = 0;
+            if (value.length() != sizeof(d))
+                return false;
+            std::memcpy(&d, value.data(), sizeof(d));
+            if (ctx.byteswapped)
+                d = (static_cast<std::uint64_t>(swap32(d & 0xffffffff)) << 32) | swap32(d >> 32);
+            double num;
+            std::memcpy(&num, &d, sizeof(num));
+            ret = fmt::format("{:g}", num);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool gvdb_lookup(const gvdb_ctx_t& ctx, const std::string_view key, std::string& ret)
+{
+    if (ctx.n_buckets == 0 || ctx.n_items == 0)
+        return false;
+
+    const std::uint32_t hash   = gvdb_hash(key);
+    const std::uint32_t bucket = hash % ctx.n_buckets;
+
+    std::uint32_t       itemno = read_u32(ctx, ctx.buckets + bucket * 4);
+    const std::uint32_t lastno =
+        (bucket + 1 < ctx.n_buckets) ? read_u32(ctx, ctx.buckets + (bucket + 1) * 4) : ctx.n_items;
+
+    for (; itemno < lastno && itemno < ctx.n_items; ++itemno)
+    {
+        const gvdb_item_t& item = read_item(ctx, itemno);
+        if (item.hash_value != hash || item.type != 'v' || !check_key(ctx, item, key))
+            continue;
+
+        if (item.value_start > item.value_end || item.value_end > ctx.data.size())
+            return false;
+
+        return variant_to_string(ctx, ctx.data.substr(item.value_start, item.value_end - item.value_start), ret);
+    }
+
+    return false;
+}
+
+bool gvdb_read_keys(const std::string_view path, const std::vector<std::string>& keys,
+                    std::vector<std::string>& values)
+{
+    std::ifstream f(path.data(), std::ios::binary);
+    if (!f.is_open())
+        return false;
+
+    const std::string buffer{ std::istreambuf_iterator<char>{ f }, std::istreambuf_iterator<char>{} };
+    gvdb_ctx_t        ctx;
+    ctx.data = buffer;
+
+    // struct gvdb_header
+    if (ctx.data.size() < 24)
+        return false;
+
+    if (read_u32(ctx, 0) == swap32(GVDB_SIGNATURE0) && read_u32(ctx, 4) == swap32(GVDB_SIGNATURE1))
+        ctx.byteswapped = true;
+    else if (read_u32(ctx, 0) != GVDB_SIGNATURE0 || read_u32(ctx, 4) != GVDB_SIGNATURE1)
+        return false;
+
+    const std::uint32_t root_start = read_u32(ctx, 16);
+    const std::uint32_t root_end   = read_u32(ctx, 20);
+    if (root_start > root_end || root_end > ctx.data.size() || root_end - root_start < 8)
+        return false;
+
+    // struct gvdb_hash_header
+    const std::uint32_t n_bloom_words = read_u32(ctx, root_start) & ((1 << 27) - 1);
+    ctx.n_buckets                     = read_u32(ctx, root_start + 4);
+    ctx.buckets                       = root_start + 8 + n_bloom_words * 4;
+    if (ctx.buckets > root_end || ctx.n_buckets > (root_end - ctx.buckets) / 4)
+        return false;
+
+    ctx.items = ctx.buckets + ctx.n_buckets * 4;
+
+    ctx.n_items = (root_end - ctx.items) / GVDB_ITEM_SIZE;
+
+    values.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i)
+        gvdb_lookup(ctx, keys[i], values[i]);
+
+    return true;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2025 Toni500git
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "hwmon.hh"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <unordered_map>
+
+#include "util.hpp"
+
+// temp10_input -> 10
+static unsigned long get_temp_number(const std::string& filename)
+{ return std::strtoul(filename.c_str() + "temp"_len, nullptr, 10); }
+
+static void index_hwmon_dir(const std::filesystem::path& dir, const std::string& chip, const size_t chip_index,
+                            std::vector<hwmon_sensor_t>& sensors)
+{
+    std::vector<std::string> inputs;
+    std::error_code          ec;
+    for (const auto& entry : std::filesystem::directory_iterator{ dir, ec })
+    {
+        const std::string& filename = entry.path().filename().string();
+        if (hasStart(filename, "temp") && hasEnding(filename, "_input"))
+            inputs.push_back(filename);
+    }
+
+    std::sort(inputs.begin(), inputs.end(), [](const std::string& a, const std::string& b) {
+        return get_temp_number(a) < get_temp_number(b);
+    });
+
+    for (const std::string& input : inputs)
+    {
+        const int fd = open((dir / input).c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            continue;
+
+        const std::string& prefix = input.substr(0, input.length() - "_input"_len);
+        std::string        label  = read_by_syspath((dir / (prefix + "_label")).string());
+        if (label == UNKNOWN || label.empty())
+            label = prefix;
+        else
+            strip(label);
+
+        debug("hwmon sensor {}[{}] {} = {}", chip, chip_index, label, (dir / input).string());
+        sensors.push_back({ chip, label, chip_index, fd });
+    }
+}
+
+const std::vector<hwmon_sensor_t>& hwmon_get_sensors()
+{
+    static std::vector<hwmon_sensor_t> sensors;
+    static bool                        done = false;
+    if (done)
+        return sensors;
+
+    done = true;
+    std::vector<std::filesystem::path>      dirs;
+    std::unordered_map<std::string, size_t> chips_count;
+    std::error_code                         ec;
+    for (const auto& entry : std::filesystem::directory_iterator{ "/sys/class/hwmon/", ec })
+        dirs.push_back(entry.path());
+
+    // hwmon2 before hwmon10
+    std::sort(dirs.begin(), dirs.end(), [](const std::filesystem::path& a, const std::filesystem::path& b) {
+        return std::strtoul(a.filename().c_str() + "hwmon"_len, nullptr, 10) <
+               std::strtoul(b.filename().c_str() + "hwmon"_len, nullptr, 10);
+    });
+
+    for (const std::filesystem::path& dir : dirs)
+    {
+        std::string chip = read_by_syspath((dir / "name").string());
+        if (chip == UNKNOWN)
+            continue;
+        strip(chip);
+
+        const size_t chip_index = chips_count[chip]++;
+
+        // older kernels have the sensors in the device directory
+        const size_t n_sensors = sensors.size();
+        index_hwmon_dir(dir, chip, chip_index, sensors);
+        if (sensors.size() == n_sensors)
+            index_hwmon_dir(dir / "device", chip, chip_index, sensors);
+    }
+
+    return sensors;
+}
+
+const hwmon_sensor_t* hwmon_find_sensor(const std::string_view chip, const std::string_view label,
+                                        const size_t chip_index)
+{
+    for (const hwmon_sensor_t& sensor : hwmon_get_sensors())
+    {
+        if (sensor.chip == chip && sensor.chip_index == chip_index && (label.empty() || sensor.label == label))
+            return &sensor;
+    }
+
+    return nullptr;
+}
+
+double hwmon_read_temp(const hwmon_sensor_t& sensor)
+{
+    // sysfs regenerates the value at every read from offset 0
+    char          buf[32];
+    const ssize_t n = pread(sensor.fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0)
+        return NAN;
+
+    buf[n] = '\0';
+    char*      end;
+    const long millidegrees = std::strtol(buf, &end, 10);
+    if (end == buf)
+        return NAN;
+
+    return millidegrees / 1000.0;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2025 Toni500git
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _HWMON_HPP
+#define _HWMON_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct hwmon_sensor_t
+{
+    std::string chip;        // hwmon chip name (e.g "k10temp", "amdgpu", "nvme")
+    std::string label;       // content of tempN_label, or "tempN" if it doesn't have one
+    size_t      chip_index;  // to tell apart chips with the same name (e.g two nvme drives)
+    int         fd;          // opened tempN_input file
+};
+
+/* Get all the temperature sensors found in /sys/class/hwmon.
+ * The index is built only once and the tempN_input files are kept open,
+ * so reading a sensor is just a pread().
+ */
+const std::vector<hwmon_sensor_t>& hwmon_get_sensors();
+
+/* Find a temperature sensor in the hwmon index
+ * @param chip The hwmon chip name
+ * @param label The sensor label (empty for the first sensor of the chip)
+ * @param chip_index Which chip to query if there are multiple with the same name
+ * @return nullptr if not found
+ */
+const hwmon_sensor_t* hwmon_find_sensor(const std::string_view chip, const std::string_view label = "",
+                                        const size_t chip_index = 0);
+
+/* Read the current temperature of a sensor
+ * @return the temperature in Celsius, or NAN on failure
+ */
+double hwmon_read_temp(const hwmon_sensor_t& sensor);
+
+#endif  // _HWMON_HPP
@@ -48,7 +48,19 @@ MODFUNC(battery_status)
 MODFUNC(battery_perc)
 { return MAGIC_LINE; }
 
-double battery_temp()
+MODFUNC(battery_cycle_count)
+{ return MAGIC_LINE; }
+
+MODFUNC(battery_energy_now)
+{ return MAGIC_LINE; }
+
+MODFUNC(battery_power_now)
+{ return MAGIC_LINE; }
+
+MODFUNC(battery_total_perc)
+{ return MAGIC_LINE; }
+
+double battery_temp(const callbackInfo_t*)
 { return 0; }
 
 #endif
@@ -94,4 +94,18 @@ MODFUNC(cpu_freq_max)
 
 MODFUNC(cpu_freq_bios) { return MAGIC_LINE; }
 
+// clang-format off
+MODFUNC(cpu_usage_total)
+{ return MAGIC_LINE; }
+
+MODFUNC(cpu_usage_core)
+{ return MAGIC_LINE; }
+
+MODFUNC(cpu_usage_iowait)
+{ return MAGIC_LINE; }
+
+MODFUNC(cpu_usage_steal)
+{ return MAGIC_LINE; }
+// clang-format on
+
 #endif
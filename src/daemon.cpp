@@ -0,0 +1,293 @@
+/*
+ * Copyright 2025 Toni500git
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "daemon.hpp"
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "fmt/format.h"
+#include "util.hpp"
+
+// Request: "CFD1", u16 columns, u8 no_color, u16 length of the config path, config path
+// Reply:   u8 status (0 = ok), then the frame until the connection is closed
+constexpr std::string_view DAEMON_MAGIC     = "CFD1";
+constexpr size_t           REQUEST_HDR_SIZE = DAEMON_MAGIC.length() + 2 + 1 + 2;
+constexpr std::uint16_t    MAX_PATH_LENGTH  = 4096;
+
+// how long to wait for the other side before giving up
+constexpr time_t SOCKET_TIMEOUT_SECS = 1;
+
+std::filesystem::path Daemon::get_socket_path()
+{
+    const char* runtime_dir = std::getenv("XDG_RUNTIME_DIR");
+    if (runtime_dir != NULL && runtime_dir[0] != '\0')
+        return std::filesystem::path(runtime_dir) / "customfetch.sock";
+
+    return fmt::format("/tmp/customfetch-{}.sock", getuid());
+}
+
+static bool fill_sockaddr(const std::filesystem::path& path, struct sockaddr_un& addr)
+{
+    const std::string& str = path.string();
+    if (str.length() >= sizeof(addr.sun_path))
+        return false;
+
+    addr            = {};
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, str.c_str(), str.length() + 1);
+    return true;
+}
+
+static void set_timeouts(const int fd)
+{
+    const struct timeval tv = { SOCKET_TIMEOUT_SECS, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+static bool send_all(const int fd, std::string_view buf)
+{
+    while (!buf.empty())
+    {
+        const ssize_t n = send(fd, buf.data(), buf.length(), MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        buf.remove_prefix(n);
+    }
+
+    return true;
+}
+
+static bool recv_all(const int fd, char* buf, size_t len)
+{
+    while (len > 0)
+    {
+        const ssize_t n = recv(fd, buf, len, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        buf += n;
+        len -= n;
+    }
+
+    return true;
+}
+
+static int connect_socket(const std::filesystem::path& path)
+{
+    struct sockaddr_un addr;
+    if (!fill_sockaddr(path, addr))
+        return -1;
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+// Anyone can create the socket in /tmp before the daemon does, or connect to it,
+// so both sides check that the other one is from the same user
+static bool is_peer_ours(const int fd)
+{
+#if defined(SO_PEERCRED)
+    struct ucred cred{};
+    socklen_t    len = sizeof(cred);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0)
+        return false;
+    const uid_t uid = cred.uid;
+#else
+    uid_t uid;
+    gid_t gid;
+    if (getpeereid(fd, &uid, &gid) != 0)
+        return false;
+#endif
+    return uid == getuid();
+}
+
+bool Daemon::request_frame(const request_t& request, std::string& frame)
+{
+    const std::string& config_path = request.config_file.string();
+    if (config_path.length() > MAX_PATH_LENGTH)
+        return false;
+
+    const int fd = connect_socket(get_socket_path());
+    if (fd < 0)
+        return false;
+
+    if (!is_peer_ours(fd))
+    {
+        warn(_("The daemon socket '{}' is owned by another user, not using it"), get_socket_path().string());
+        close(fd);
+        return false;
+    }
+
+    set_timeouts(fd);
+
+    std::string buf{ DAEMON_MAGIC };
+    buf.append(reinterpret_cast<const char*>(&request.columns), sizeof(request.columns));
+    buf.push_back(request.no_color);
+    const std::uint16_t path_len = config_path.length();
+    buf.append(reinterpret_cast<const char*>(&path_len), sizeof(path_len));
+    buf += config_path;
+
+    char status = 1;
+    bool ok     = send_all(fd, buf) && recv_all(fd, &status, 1) && status == 0;
+    if (ok)
+    {
+        char    chunk[16384];
+        ssize_t n;
+        while ((n = recv(fd, chunk, sizeof(chunk), 0)) > 0 || (n < 0 && errno == EINTR))
+            if (n > 0)
+                frame.append(chunk, n);
+
+        // timed out or failed in the middle of the frame
+        ok = (n == 0);
+    }
+
+    close(fd);
+    return ok;
+}
+
+int Daemon::listen_socket(const std::filesystem::path& path)
+{
+    struct sockaddr_un addr;
+    if (!fill_sockaddr(path, addr))
+        die(_("The daemon socket path '{}' is too long"), path.string());
+
+    if (std::filesystem::exists(path))
+    {
+        const int other = connect_socket(path);
+        if (other >= 0)
+        {
+            close(other);
+            die(_("Another customfetch daemon is already listening on '{}'"), path.string());
+        }
+
+        // left there by a daemon that didn't exit cleanly
+        unlink(path.c_str());
+    }
+
+    // the frame may show private infos, so the socket is created already with 0600
+    const int    fd       = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    const mode_t old_mask = umask(S_IRWXG | S_IRWXO);
+    const bool   ok       = fd >= 0 && bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0;
+    umask(old_mask);
+    if (!ok || listen(fd, 16) != 0)
+        die(_("Failed to listen on the daemon socket '{}': {}"), path.string(), strerror(errno));
+
+    return fd;
+}
+
+int Daemon::accept_request(const int listen_fd, request_t& request)
+{
+    const int fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC);
+    if (fd < 0)
+        return -1;
+
+    if (!is_peer_ours(fd))
+    {
+        close(fd);
+        return -1;
+    }
+
+    set_timeouts(fd);
+
+    char hdr[REQUEST_HDR_SIZE];
+    if (!recv_all(fd, hdr, sizeof(hdr)) || std::string_view(hdr, DAEMON_MAGIC.length()) != DAEMON_MAGIC)
+    {
+        close(fd);
+        return -1;
+    }
+
+    std::uint16_t path_len;
+    size_t        off = DAEMON_MAGIC.length();
+    std::memcpy(&request.columns, hdr + off, sizeof(request.columns));
+    off += sizeof(request.columns);
+    request.no_color = hdr[off++] != 0;
+    std::memcpy(&path_len, hdr + off, sizeof(path_len));
+
+    std::string path(path_len, '\0');
+    if (path_len > MAX_PATH_LENGTH || !recv_all(fd, path.data(), path.length()))
+    {
+        close(fd);
+        return -1;
+    }
+
+    request.config_file = path;
+    return fd;
+}
+
+void Daemon::send_frame(const int client_fd, const bool ok, const std::string_view frame)
+{
+    const char status = ok ? 0 : 1;
+    if (send_all(client_fd, std::string_view(&status, 1)) && ok)
+        send_all(client_fd, frame);
+
+    close(client_fd);
+}
+
+std::string Daemon::strip_colors(const std::string_view frame)
+{
+    std::string ret;
+    ret.reserve(frame.length());
+    for (size_t i = 0; i < frame.length(); ++i)
+    {
+        if (frame[i] != '\033' || i + 1 >= frame.length() || frame[i + 1] != '[')
+        {
+            ret += frame[i];
+            continue;
+        }
+
+        // find the final byte of the control sequence
+        size_t end = i + 2;
+        while (end < frame.length() && (frame[end] < 0x40 || frame[end] > 0x7e))
+            ++end;
+
+        if (end < frame.length() && frame[end] == 'm')
+            i = end;
+        else
+            ret += frame[i];
+    }
+
+    return ret;
+}
@@ -43,25 +43,30 @@
 #include <pty.h>
 #endif
 
+#include <poll.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <termios.h>
 #include <unistd.h>
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <optional>
 #include <vector>
 
 #include "core-modules.hh"
 #include "fmt/core.h"
 #include "fmt/format.h"
+#include "image.hpp"
 #include "parse.hpp"
 #include "platform.hpp"
+#include "profile.hpp"
 #include "stb_image.h"
 #include "tiny-process-library/process.hpp"
-#include "utf8/checked.h"
 #include "util.hpp"
 
 std::string Display::detect_distro(const Config& config)
@@ -95,19 +100,37 @@ std::string Display::detect_distro(const Config& config)
 #endif
 }
 
+// The image backend chosen with --image-backend, else the best graphics protocol the terminal supports
+static std::string get_image_backend(const Config& config)
+{
+    if (!config.args_image_backend.empty())
+        return config.args_image_backend;
+
+    const term_caps_t& caps = Display::get_term_caps();
+    if (caps.kitty_graphics)
+        return "kitty";
+    if (caps.sixel)
+        return "sixel";
+
+    const char* term_program = std::getenv("TERM_PROGRAM");
+    if (term_program && (std::string_view(term_program) == "iTerm.app" || std::string_view(term_program) == "WezTerm"))
+        return "iterm2";
+
+    die(_("Couldn't find a graphics protocol supported by the terminal for displaying the image.\n"
+          "Please use --image-backend or the GUI mode (use -h for more details)"));
+    return "";
+}
+
 static std::vector<std::string> render_with_image(const moduleMap_t& modulesInfo, std::vector<std::string>& layout,
                                                   const Config& config, const std::filesystem::path& path,
                                                   const std::uint16_t font_width, const std::uint16_t font_height)
 {
     int image_width, image_height, channels;
 
-    // load the image and get its width and height
-    unsigned char* img = stbi_load(path.c_str(), &image_width, &image_height, &channels, 0);
-
-    if (!img)
+    // only read the width and height, the image is decoded when encoding it for the terminal
+    if (!stbi_info(path.c_str(), &image_width, &image_height, &channels))
         die(_("Unable to load image '{}'"), path.string());
 
-    stbi_image_free(img);
     if (Display::ascii_logo_fd != -1)
     {
         remove(path.c_str());
@@ -141,26 +164,31 @@ static std::vector<std::string> render_with_image(const moduleMap_t& modulesInfo
                  layout.end());
 
     // took math from neofetch in get_term_size() and get_image_size(). seems to work nice
-    const size_t width  = image_width / font_width;
-    const size_t height = image_height / font_height;
-
-    if (config.args_image_backend == "kitty")
-        TinyProcessLib::Process({ "kitty", "+kitten", "icat", "--align",
-                                  (config.logo_position == "top" ? "center" : config.logo_position), "--place",
-                                  fmt::format("{}x{}@0x0", width, height), path.string() });
-    else if (config.args_image_backend == "viu")
+    const size_t width  = std::max(image_width / font_width, 1);
+    const size_t height = std::max(image_height / font_height, 1);
+
+    const std::string& backend = get_image_backend(config);
+    if (backend == "kitty" || backend == "sixel" || backend == "iterm2")
+    {
+        const std::string& payload = Image::encode(path, backend, width, height, font_width, font_height);
+        write(STDOUT_FILENO, payload.data(), payload.length());
+    }
+    else if (backend == "viu")
+    {
+        Profile::record_spawn("viu");
         TinyProcessLib::Process(
             { "viu", "-t", "-w", fmt::to_string(width), "-h", fmt::to_string(height), path.string() });
+    }
     else
-        die(_("The image backend '{}' isn't supported, only 'kitty' and 'viu'.\n"
+    {
+        die(_("The image backend '{}' isn't supported, only 'kitty', 'sixel', 'iterm2' and 'viu'.\n"
               "Please currently use the GUI mode for rendering the image/gif (use -h for more details)"),
-            config.args_image_backend);
+            backend);
+    }
 
     if (config.logo_position == "top")
     {
-        for (size_t _ = 0; _ < height + config.layout_padding_top; ++_)
-            layout.insert(layout.begin(), "");
-
+        layout.insert(layout.begin(), height + config.layout_padding_top, "");
         return layout;
     }
 
@@ -170,86 +198,336 @@ static std::vector<std::string> render_with_image(const moduleMap_t& modulesInfo
             : std::stoi(config.offset);
 
     for (std::string& str : layout)
-        for (size_t _ = 0; _ < width + offset; ++_)
-            str.insert(0, " ");
+        str.insert(0, width + offset, ' ');
 
     return layout;
 }
 
-// https://stackoverflow.com/a/50888457
-// with a little C++ modernizing
-static bool get_pos(int& y, int& x)
+// The parsed logo, kept across renders (live mode and GUI) until the file changes
+struct logo_cache_t
+{
+    std::filesystem::path           path;
+    std::filesystem::file_time_type mtime;
+    bool                            is_temp  = false;  // the temporary logo file has been already removed
+    bool                            is_image = false;
+    std::vector<std::string>        lines;
+    std::vector<size_t>             pure_lens;  // length of each line without colors
+    size_t                          max_line_length = 0;
+};
+
+static std::optional<logo_cache_t> logo_cache;
+
+static bool is_logo_cached(const std::filesystem::path& path)
 {
-    std::array<char, 32> buf;
-    int                  ret, i, pow;
-    char                 ch;
+    if (!logo_cache || logo_cache->path != path)
+        return false;
 
-    y = 0;
-    x = 0;
+    if (logo_cache->is_temp)
+        return true;
 
-    struct termios term, restore;
+    std::error_code ec;
+    const auto&     mtime = std::filesystem::last_write_time(path, ec);
+    return !ec && mtime == logo_cache->mtime;
+}
 
-    tcgetattr(0, &term);
-    tcgetattr(0, &restore);
-    term.c_lflag &= ~(ICANON | ECHO);
-    tcsetattr(0, TCSANOW, &term);
+static void load_logo(const Config& config, const bool already_analyzed_file, const std::filesystem::path& path,
+                      const moduleMap_t& moduleMap, std::vector<std::string>& layout)
+{
+    debug("load_logo path = {}", path.string());
+    Profile::Span span("phase", "logo");
+
+    std::ifstream file(path.string(), std::ios::binary);
+    if (!file.is_open())
+        die(_("Could not open logo file '{}'"), path.string());
+
+    logo_cache.emplace();
+    logo_cache->path = path;
+
+    std::error_code ec;
+    logo_cache->mtime = std::filesystem::last_write_time(path, ec);
+
+    // first check if the file is an image
+    // without even using the same library that "file" uses
+    // No extra bloatware nice
+    if (!already_analyzed_file)
+    {
+        debug("load_logo() analyzing file");
+        std::array<unsigned char, 32> buffer;
+        file.read(reinterpret_cast<char*>(&buffer.at(0)), buffer.size());
+        logo_cache->is_image = is_file_image(buffer.data());
+        file.clear();
+        file.seekg(0);
+    }
+
+    // images are rendered with render_with_image()
+    if (logo_cache->is_image)
+        return;
+
+    if (Display::ascii_logo_fd != -1)
+    {
+        remove(path.c_str());
+        close(Display::ascii_logo_fd);
+        Display::ascii_logo_fd = -1;
+        logo_cache->is_temp    = true;
+    }
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::string              pureOutput;
+        std::vector<std::string> tmp_layout;
+        parse_args_t             parse_args{ moduleMap, config, pureOutput, layout, tmp_layout, false };
+
+        std::string asciiArt_s   = parse(line, parse_args);
+        parse_args.no_more_reset = false;
+#if !GUI_APP
+        if (!config.args_disable_colors)
+            asciiArt_s += NOCOLOR;
+#else
+        // check parse.cpp
+        const size_t pos = asciiArt_s.rfind("$ </");
+        if (pos != std::string::npos)
+            asciiArt_s.replace(pos, 2, "$");
+#endif
+
+        logo_cache->lines.push_back(asciiArt_s);
+        const size_t pureOutputLen = get_display_width(pureOutput);
+
+        if (pureOutputLen > logo_cache->max_line_length)
+            logo_cache->max_line_length = pureOutputLen;
+
+        logo_cache->pure_lens.push_back(pureOutputLen);
+        debug("asciiArt_s = {}", asciiArt_s);
+    }
+}
 
-    write(1, "\033[6n", 4);
+// Rendered text of a layout line, reused in live mode until one of its modules is due again
+struct layout_line_cache_t
+{
+    std::string                           raw;    // the unparsed layout line
+    std::vector<std::string>              lines;  // a line can be expanded into multiple ones (e.g $<auto.disk>)
+    std::chrono::steady_clock::time_point due;
+};
 
-    for (i = 0, ch = 0; ch != 'R'; i++)
+static std::vector<layout_line_cache_t> layout_cache;
+
+// Get the path of all the modules in a layout line, without their arguments
+// e.g "Disk: $<disk(/).used> / $<disk(/).total>" -> ["disk.used", "disk.total"]
+static std::vector<std::string> get_line_modules(const std::string_view line)
+{
+    std::vector<std::string> modules;
+    for (size_t pos = line.find("$<"); pos != line.npos; pos = line.find("$<", pos + 2))
     {
-        ret = read(0, &ch, 1);
-        if (!ret)
+        if (pos > 0 && line[pos - 1] == '\\')
+            continue;
+
+        std::string module;
+        int         depth = 0;
+        for (size_t i = pos + 2; i < line.length(); ++i)
         {
-            tcsetattr(0, TCSANOW, &restore);
-            die(_("getpos: error reading response!"));
+            if (line[i] == '(')
+                ++depth;
+            else if (line[i] == ')')
+                --depth;
+            else if (depth == 0 && line[i] == '>')
+                break;
+            else if (depth == 0)
+                module += line[i];
         }
-        buf.at(i) = ch;
+        modules.push_back(module);
     }
 
-    if (i < 2)
+    return modules;
+}
+
+std::chrono::milliseconds Display::get_module_interval(const Config& config, const std::string_view module)
+{
+    // find the most specific interval (e.g "cpu.freq" before "cpu")
+    std::string_view path     = module;
+    auto             interval = config.live_intervals.end();
+    while (interval == config.live_intervals.end())
     {
-        tcsetattr(0, TCSANOW, &restore);
+        interval = config.live_intervals.find(std::string(path));
+        const size_t dot = path.rfind('.');
+        if (dot == path.npos)
+            break;
+        path = path.substr(0, dot);
+    }
+
+    if (interval == config.live_intervals.end())
+        return is_module_static(module) ? std::chrono::milliseconds::max() : std::chrono::milliseconds(0);
+
+    // 0 = only once
+    if (interval->second == 0)
+        return std::chrono::milliseconds::max();
+
+    return std::chrono::milliseconds(interval->second);
+}
+
+// How long the rendered text of a layout line stays valid in live mode.
+// It's the lowest interval of its modules, while lines with commands are refreshed at every tick.
+static std::chrono::milliseconds get_line_interval(const Config& config, const std::string_view line)
+{
+    if (line.find("$(") != line.npos)
+        return std::chrono::milliseconds(0);
+
+    std::chrono::milliseconds ret = std::chrono::milliseconds::max();
+    for (const std::string& module : get_line_modules(line))
+        ret = std::min(ret, Display::get_module_interval(config, module));
+
+    return ret;
+}
+
+// max time to wait for the terminal to reply to the capability queries
+constexpr int TERM_PROBE_TIMEOUT_MS = 250;
+
+// Identify the terminal session, so its capabilities are probed only once in it
+static std::string get_term_session_id()
+{
+    const char* tty = ttyname(STDIN_FILENO);
+    return fmt::format("{}:{}:{}", getsid(0), tty ? tty : "", std::getenv("TERM") ? std::getenv("TERM") : "");
+}
+
+static bool read_term_caps_cache(const std::filesystem::path& path, const std::string_view session, term_caps_t& caps)
+{
+    std::ifstream f(path);
+    std::string   cached_session;
+    if (!std::getline(f, cached_session) || cached_session != session)
         return false;
+
+    return static_cast<bool>(f >> caps.cell_width >> caps.cell_height >> caps.kitty_graphics >> caps.sixel);
+}
+
+// Parse the replies of the queries sent in probe_term_caps()
+static void parse_term_replies(const std::string_view replies, term_caps_t& caps)
+{
+    // cell size: \033[6;height;widtht
+    for (size_t pos = replies.find("\033[6;"); pos != replies.npos; pos = replies.find("\033[6;", pos + 1))
+    {
+        unsigned int height = 0, width = 0;
+        if (std::sscanf(replies.data() + pos, "\033[6;%u;%ut", &height, &width) == 2)
+        {
+            caps.cell_width  = width;
+            caps.cell_height = height;
+        }
     }
 
-    for (i -= 2, pow = 1; buf.at(i) != ';'; i--, pow *= 10)
-        x = x + (buf.at(i) - '0') * pow;
+    // kitty graphics: \033_Gi=31;OK followed by the string terminator
+    caps.kitty_graphics = replies.find("\033_Gi=31;OK") != replies.npos;
+
+    // primary device attributes: \033[?62;4;22c, where 4 means sixel
+    // (the replies aren't NUL terminated, so walk them as a string_view instead of using split())
+    const size_t da     = replies.find("\033[?");
+    const size_t da_end = (da != replies.npos) ? replies.find('c', da) : replies.npos;
+    if (da_end != replies.npos)
+    {
+        std::string_view attrs = replies.substr(da + 3, da_end - da - 3);
+        while (!attrs.empty())
+        {
+            const size_t sep = attrs.find(';');
+            if (attrs.substr(0, sep) == "4")
+                caps.sixel = true;
+            attrs.remove_prefix(sep == attrs.npos ? attrs.length() : sep + 1);
+        }
+    }
+}
+
+// Send all the queries at once, and read the replies until the terminal answers
+// the primary device attributes query (every terminal does, and it's sent last) or we run out of time
+static term_caps_t probe_term_caps()
+{
+    term_caps_t caps;
+
+    struct termios term, restore;
+    if (tcgetattr(STDIN_FILENO, &term) != 0)
+        return caps;
+    restore = term;
+    term.c_lflag &= ~(ICANON | ECHO);
+    tcsetattr(STDIN_FILENO, TCSANOW, &term);
 
-    for (i--, pow = 1; buf.at(i) != '['; i--, pow *= 10)
-        y = y + (buf.at(i) - '0') * pow;
+    // cell size in pixels, kitty graphics protocol query with a 1x1 RGB image, primary device attributes
+    constexpr std::string_view queries = "\033[16t\033_Gi=31,s=1,v=1,a=q,t=d,f=24;AAAA\033\\\033[c";
+    write(STDOUT_FILENO, queries.data(), queries.length());
 
-    tcsetattr(0, TCSANOW, &restore);
-    return true;
+    std::string   replies;
+    const auto    deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(TERM_PROBE_TIMEOUT_MS);
+    struct pollfd pfd      = { STDIN_FILENO, POLLIN, 0 };
+    while (true)
+    {
+        const auto left =
+            std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (left <= 0 || poll(&pfd, 1, left) <= 0)
+        {
+            debug("probe_term_caps: timed out, got {} bytes", replies.length());
+            break;
+        }
+
+        char          buf[256];
+        const ssize_t len = read(STDIN_FILENO, buf, sizeof(buf));
+        if (len <= 0)
+            break;
+        replies.append(buf, len);
+
+        const size_t da = replies.find("\033[?");
+        if (da != replies.npos && replies.find('c', da) != replies.npos)
+            break;
+    }
+
+    tcsetattr(STDIN_FILENO, TCSANOW, &restore);
+    parse_term_replies(replies, caps);
+    return caps;
+}
+
+const term_caps_t& Display::get_term_caps()
+{
+    static std::optional<term_caps_t> caps;
+    if (caps)
+        return *caps;
+
+    caps.emplace();
+    if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO))
+        return *caps;
+
+    const std::filesystem::path& cache_path = getCacheDir() / "term-caps";
+    const std::string&           session    = get_term_session_id();
+    if (read_term_caps_cache(cache_path, session, *caps))
+    {
+        debug("get_term_caps: using cached capabilities of session {}", session);
+        Profile::count("cache_hit.term_caps");
+        return *caps;
+    }
+
+    Profile::Span span("phase", "term_caps_probe");
+    *caps = probe_term_caps();
+    span.end();
+    debug("get_term_caps: cell = {}x{}, kitty = {}, sixel = {}", caps->cell_width, caps->cell_height,
+          caps->kitty_graphics, caps->sixel);
+
+    std::error_code ec;
+    std::filesystem::create_directories(cache_path.parent_path(), ec);
+    std::ofstream f(cache_path, std::ios::trunc);
+    f << session << '\n'
+      << caps->cell_width << ' ' << caps->cell_height << ' ' << caps->kitty_graphics << ' ' << caps->sixel << '\n';
+
+    return *caps;
 }
 
 std::vector<std::string> Display::render(const Config& config, const bool already_analyzed_file,
                                          const std::filesystem::path& path, const moduleMap_t& moduleMap)
 {
+    Profile::Span            span("phase", "render");
     std::vector<std::string> asciiArt{}, layout{ config.args_layout.empty() ? config.layout : config.args_layout };
 
     debug("Display::render path = {}", path.string());
 
-    bool          isImage = false;
-    std::ifstream file;
+    bool isImage = false;
     if (!config.args_disable_source)
     {
-        file.open(path.string(), std::ios::binary);
-        if (!file.is_open())
-            die(_("Could not open logo file '{}'"), path.string());
-
-        // first check if the file is an image
-        // without even using the same library that "file" uses
-        // No extra bloatware nice
-        if (!already_analyzed_file)
-        {
-            debug("Display::render() analyzing file");
-            std::array<unsigned char, 32> buffer;
-            file.read(reinterpret_cast<char*>(&buffer.at(0)), buffer.size());
-            isImage = is_file_image(buffer.data());
-            file.clear();
-            file.seekg(0);
-        }
+        if (!is_logo_cached(path))
+            load_logo(config, already_analyzed_file, path, moduleMap, layout);
+        else
+            Profile::count("cache_hit.logo");
+        isImage = logo_cache->is_image;
     }
 
     if (!config.m_display_distro && isImage)
@@ -283,94 +561,97 @@ std::vector<std::string> Display::render(const Config& config, const bool alread
     std::vector<size_t> pureAsciiArtLens;
     size_t              maxLineLength = 0;
 
-    struct winsize win;
+    struct winsize win{};
     ioctl(STDOUT_FILENO, TIOCGWINSZ, &win);
+    // the size of the cells in pixels right now (it changes with the font size)
+    std::uint16_t font_width  = win.ws_col > 0 ? win.ws_xpixel / win.ws_col : 0;
+    std::uint16_t font_height = win.ws_row > 0 ? win.ws_ypixel / win.ws_row : 0;
+    if (Display::columns > 0)
+        win.ws_col = Display::columns;
 
     if (isImage)
     {
-        // clear screen
-        write(STDOUT_FILENO, "\33[H\33[2J", 7);
-
-        const std::uint16_t font_width  = win.ws_xpixel / win.ws_col;
-        const std::uint16_t font_height = win.ws_ypixel / win.ws_row;
+        // some terminals (or ssh) don't report the window size in pixels, ask the terminal itself
+        if (font_width == 0 || font_height == 0)
+        {
+            const term_caps_t& caps = get_term_caps();
+            font_width              = caps.cell_width;
+            font_height             = caps.cell_height;
+        }
+        if (font_width == 0 || font_height == 0)
+            die(_("Couldn't get the size of the terminal cells in pixels, needed for rendering the image"));
 
-        // why... why reverse the cardinal coordinates..
-        int y = 0, x = 0;
-        get_pos(y, x);
-        fmt::print("\033[{};{}H", y, x);
+        // clear screen, this also moves the cursor at the top left
+        write(STDOUT_FILENO, "\33[H\33[2J", 7);
 
         return render_with_image(moduleMap, layout, config, path, font_width, font_height);
     }
 
-    if (Display::ascii_logo_fd != -1)
-    {
-        remove(path.c_str());
-        close(Display::ascii_logo_fd);
-    }
-
     for (uint i = 0; i < config.logo_padding_top; i++)
     {
         pureAsciiArtLens.push_back(0);
         asciiArt.emplace_back("");
     }
 
-    for (uint i = 0; i < config.layout_padding_top; i++)
-    {
-        layout.insert(layout.begin(), "");
-    }
+    layout.insert(layout.begin(), config.layout_padding_top, "");
 
-    std::string line;
-    while (std::getline(file, line))
+    if (!config.args_disable_source)
     {
-        std::string              pureOutput;
-        std::vector<std::string> tmp_layout;
-        parse_args_t             parse_args{ moduleMap, config, pureOutput, layout, tmp_layout, false };
-
-        std::string asciiArt_s   = parse(line, parse_args);
-        parse_args.no_more_reset = false;
-#if !GUI_APP
-        if (!config.args_disable_colors)
-            asciiArt_s += NOCOLOR;
-#else
-        // check parse.cpp
-        const size_t pos = asciiArt_s.rfind("$ </");
-        if (pos != std::string::npos)
-            asciiArt_s.replace(pos, 2, "$");
-#endif
-
-        asciiArt.push_back(asciiArt_s);
-        const size_t pureOutputLen = utf8::distance(pureOutput.begin(), pureOutput.end());
-
-        if (pureOutputLen > maxLineLength)
-            maxLineLength = pureOutputLen;
-
-        pureAsciiArtLens.push_back(pureOutputLen);
-        debug("asciiArt_s = {}", asciiArt_s);
+        asciiArt.insert(asciiArt.end(), logo_cache->lines.begin(), logo_cache->lines.end());
+        pureAsciiArtLens.insert(pureAsciiArtLens.end(), logo_cache->pure_lens.begin(), logo_cache->pure_lens.end());
+        maxLineLength = logo_cache->max_line_length;
     }
 
     if (config.args_print_logo_only)
         return asciiArt;
 
     std::string              _;
-    std::vector<std::string> tmp_layout;
+    std::vector<std::string> tmp_layout, rendered_layout;
     parse_args_t             parse_args{ moduleMap, config, _, layout, tmp_layout, true };
+
+    // in live mode, only parse again the lines that have a module due for refresh
+    const auto now = std::chrono::steady_clock::now();
+    if (is_live_mode)
+        layout_cache.resize(layout.size());
+
     for (size_t i = 0; i < layout.size(); ++i)
     {
-        layout[i]                = parse(layout[i], parse_args);
+        if (is_live_mode && layout_cache[i].raw == layout[i] && now < layout_cache[i].due)
+        {
+            Profile::count("cache_hit.layout_line");
+            rendered_layout.insert(rendered_layout.end(), layout_cache[i].lines.begin(), layout_cache[i].lines.end());
+            continue;
+        }
+
+        std::string line         = parse(layout[i], parse_args);
         parse_args.no_more_reset = false;
 #if !GUI_APP
         if (!config.args_disable_colors)
-            layout[i].insert(0, NOCOLOR);
+            line.insert(0, NOCOLOR);
 #endif
 
+        std::vector<std::string> lines;
         if (!tmp_layout.empty())
+            lines = std::move(tmp_layout);
+        else
+            lines.push_back(std::move(line));
+        tmp_layout.clear();
+
+        if (is_live_mode)
         {
-            layout.erase(layout.begin() + i);
-            layout.insert(layout.begin() + i, tmp_layout.begin(), tmp_layout.end());
-            i += tmp_layout.size() - 1;
-            tmp_layout.clear();
+            const std::chrono::milliseconds interval = get_line_interval(config, layout[i]);
+
+            layout_cache[i].raw   = layout[i];
+            layout_cache[i].lines = lines;
+            layout_cache[i].due   = (interval == std::chrono::milliseconds::max())
+                                        ? std::chrono::steady_clock::time_point::max()
+                                        : now + interval;
         }
+
+        rendered_layout.insert(rendered_layout.end(), std::make_move_iterator(lines.begin()),
+                               std::make_move_iterator(lines.end()));
     }
+    layout = std::move(rendered_layout);
 
     // erase each element for each instance of MAGIC_LINE
     layout.erase(std::remove_if(layout.begin(), layout.end(),
@@ -390,51 +671,195 @@ std::vector<std::string> Display::render(const Config& config, const bool alread
             ? calc_perc(std::stof(config.offset.substr(0, config.offset.size() - 1)), win.ws_col, maxLineLength)
             : std::stoi(config.offset);
 
-    size_t i;
-    for (i = 0; i < layout.size(); i++)
-    {
-        size_t origin = config.logo_padding_left;
+    // build each line only once: padding, logo, gap and then the layout
+    const size_t             logo_width = maxLineLength + (config.args_disable_source ? 0 : offset);
+    std::vector<std::string> frame;
+    frame.reserve(std::max(layout.size(), asciiArt.size()));
 
-        // The user-specified offset to be put before the logo
-        for (size_t j = 0; j < config.logo_padding_left; ++j)
-            layout.at(i).insert(0, " ");
+    for (size_t i = 0; i < layout.size() || i < asciiArt.size(); ++i)
+    {
+        const bool   has_logo = i < asciiArt.size();
+        const size_t spaces   = logo_width - (has_logo ? pureAsciiArtLens.at(i) : 0);
 
-        if (i < asciiArt.size())
+        std::string line;
+        if (i >= layout.size())
         {
-            layout.at(i).insert(origin, asciiArt.at(i));
-            origin += asciiArt.at(i).length();
+            line.reserve(config.logo_padding_left + asciiArt.at(i).length());
+            line.append(config.logo_padding_left, ' ');
+            line += asciiArt.at(i);
+            frame.push_back(std::move(line));
+            continue;
         }
 
-        const size_t spaces = (maxLineLength + (config.args_disable_source ? 0 : offset)) -
-                              (i < asciiArt.size() ? pureAsciiArtLens.at(i) : 0);
+        line.reserve(config.logo_padding_left + (has_logo ? asciiArt.at(i).length() : 0) + spaces +
+                     layout.at(i).length() + sizeof(NOCOLOR));
 
-        debug("spaces: {}", spaces);
-
-        for (size_t j = 0; j < spaces; j++)
-            layout.at(i).insert(origin, " ");
+        // The user-specified offset to be put before the logo
+        line.append(config.logo_padding_left, ' ');
+        if (has_logo)
+            line += asciiArt.at(i);
+        line.append(spaces, ' ');
+        line += layout.at(i);
 
 #if !GUI_APP
         if (!config.args_disable_colors)
-            layout.at(i) += NOCOLOR;
+            line += NOCOLOR;
 #endif
+        frame.push_back(std::move(line));
     }
 
-    for (; i < asciiArt.size(); ++i)
+    return frame;
+}
+
+// lines of the last frame displayed in live mode
+static std::vector<std::string> last_frame;
+
+void Display::reset_frame()
+{ last_frame.clear(); }
+
+void Display::reset_caches()
+{
+    logo_cache.reset();
+    layout_cache.clear();
+}
+
+// Terminals that don't know the synchronized output mode (2026) just ignore it,
+// except the linux console and dumb terminals that might print it
+static bool supports_synchronized_output()
+{
+    static const bool ret = [] {
+        const char* term = std::getenv("TERM");
+        return term && *term && std::string_view(term) != "dumb" && std::string_view(term) != "linux";
+    }();
+    return ret;
+}
+
+// writev() all the buffers to stdout, continuing after partial writes
+static void write_all(struct iovec* iov, int iovcnt)
+{
+    while (iovcnt > 0)
     {
-        std::string line(config.logo_padding_left, ' ');
-        line += asciiArt.at(i);
+        const ssize_t n = writev(STDOUT_FILENO, iov, iovcnt);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            // stdout is non-blocking (e.g shared with a program that set O_NONBLOCK),
+            // wait for it to be writable instead of spinning on writev()
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                struct pollfd pfd{ STDOUT_FILENO, POLLOUT, 0 };
+                if (poll(&pfd, 1, -1) >= 0 || errno == EINTR)
+                    continue;
+            }
+            return;
+        }
+
+        size_t written = n;
+        while (iovcnt > 0 && written >= iov->iov_len)
+        {
+            written -= iov->iov_len;
+            ++iov;
+            --iovcnt;
+        }
 
-        layout.push_back(line);
+        if (iovcnt > 0)
+        {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + written;
+            iov->iov_len -= written;
+        }
     }
+}
 
-    return layout;
+// Write the whole frame at once, wrapped in a synchronized update if asked,
+// so the terminal draws it atomically instead of showing it half updated
+static void flush_frame(const std::string_view frame, const bool synchronized)
+{
+    constexpr std::string_view sync_begin = "\033[?2026h";
+    constexpr std::string_view sync_end   = "\033[?2026l";
+
+    // anything still buffered by stdio must be printed before the frame
+    std::fflush(stdout);
+
+    const bool   sync   = synchronized && supports_synchronized_output();
+    struct iovec iov[4] = {
+        { const_cast<char*>(Display::frame_prefix.data()), Display::frame_prefix.length() },
+        { const_cast<char*>(sync_begin.data()), sync ? sync_begin.length() : 0 },
+        { const_cast<char*>(frame.data()), frame.length() },
+        { const_cast<char*>(sync_end.data()), sync ? sync_end.length() : 0 },
+    };
+
+    write_all(iov, 4);
+    Display::frame_prefix.clear();
 }
 
-void Display::display(const std::vector<std::string>& renderResult)
+static bool fits_in_terminal(const size_t lines)
 {
-    for (const std::string& str : renderResult)
+    struct winsize win{};
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &win) != 0 || win.ws_row == 0)
+        return true;
+
+    // the cursor goes to the line after the frame
+    return lines < win.ws_row;
+}
+
+void Display::display(const std::vector<std::string>& renderResult, const bool redraw_changes, const bool clear_screen)
+{
+    Profile::Span span("phase", "display");
+
+    // reused across the frames of live mode
+    static std::string out;
+    out.clear();
+
+    // the changed lines are redrawn at their absolute row, which gets clamped
+    // to the last one when the frame is taller than the terminal. Draw everything then
+    const bool redraw_all = redraw_changes && !fits_in_terminal(renderResult.size());
+    if (redraw_all)
+        last_frame.clear();
+
+    if (!redraw_changes || redraw_all)
     {
-        fmt::print("{}", str);
-        fmt::print("\n");
+        if (clear_screen || redraw_all)
+            out = "\033[H\033[2J";
+
+        for (const std::string& str : renderResult)
+        {
+            out += str;
+            out += '\n';
+        }
+        flush_frame(out, clear_screen || redraw_all);
+        return;
     }
+
+    // clear screen and go to position 0, 0
+    if (last_frame.empty())
+        out = "\033[H\033[2J";
+
+    // move to each changed line, rewrite it and erase what's left of the old one
+    size_t changed = 0;
+    for (size_t i = 0; i < renderResult.size(); ++i)
+    {
+        if (i < last_frame.size() && last_frame[i] == renderResult[i])
+            continue;
+
+        ++changed;
+        fmt::format_to(std::back_inserter(out), "\033[{};1H", i + 1);
+        out += renderResult[i];
+        out += "\033[K";
+    }
+
+    // the new frame is shorter, erase the old lines below it
+    if (renderResult.size() < last_frame.size())
+        fmt::format_to(std::back_inserter(out), "\033[{};1H\033[J", renderResult.size() + 1);
+
+    // nothing changed, don't even move the cursor
+    if (out.empty())
+        return;
+
+    fmt::format_to(std::back_inserter(out), "\033[{};1H", renderResult.size() + 1);
+    debug("live frame: {} lines changed, {} bytes written", changed, out.size());
+
+    flush_frame(out, true);
+    last_frame = renderResult;
 }
@@ -120,9 +120,8 @@ static std::vector<std::string> render_with_image(const Config& config)
             ? Display::calc_perc(std::stof(config.offset.substr(0, config.offset.size() - 1)), image_width, 0)
             : std::stoi(config.offset);
 
-    for (size_t i = 0; i < layout.size(); i++)
-        for (size_t _ = 0; _ < offset; _++)  // I use _ because we don't need it
-            layout.at(i).insert(0, " ");
+    for (std::string& str : layout)
+        str.insert(0, offset, ' ');
 
     return layout;
 }
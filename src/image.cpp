@@ -0,0 +1,307 @@
+/*
+ * Copyright 2025 Toni500git
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "image.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "fmt/format.h"
+#include "profile.hpp"
+#include "stb_image.h"
+#include "util.hpp"
+
+// Encoded images are kept in memory, so live mode doesn't decode and encode them at every tick
+struct image_cache_t
+{
+    std::filesystem::path           path;
+    std::filesystem::file_time_type mtime;
+    std::string                     protocol;
+    std::uint16_t                   cols, rows;
+    std::uint16_t                   cell_width, cell_height;
+    std::string                     payload;
+
+    // kitty only: after the first time, the image is already in the terminal memory, just place it again
+    bool        transmitted = false;
+    std::string placement;
+};
+
+static std::optional<image_cache_t> image_cache;
+
+static std::string base64_encode(const std::string_view data)
+{
+    constexpr std::string_view table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string ret;
+    ret.reserve((data.length() + 2) / 3 * 4);
+    size_t i = 0;
+    for (; i + 2 < data.length(); i += 3)
+    {
+        const std::uint32_t n = (static_cast<std::uint8_t>(data[i]) << 16) |
+                                (static_cast<std::uint8_t>(data[i + 1]) << 8) | static_cast<std::uint8_t>(data[i + 2]);
+        ret += table[(n >> 18) & 63];
+        ret += table[(n >> 12) & 63];
+        ret += table[(n >> 6) & 63];
+        ret += table[n & 63];
+    }
+
+    if (i < data.length())
+    {
+        std::uint32_t n = static_cast<std::uint8_t>(data[i]) << 16;
+        if (i + 1 < data.length())
+            n |= static_cast<std::uint8_t>(data[i + 1]) << 8;
+
+        ret += table[(n >> 18) & 63];
+        ret += table[(n >> 12) & 63];
+        ret += (i + 1 < data.length()) ? table[(n >> 6) & 63] : '=';
+        ret += '=';
+    }
+
+    return ret;
+}
+
+static std::string read_file(const std::filesystem::path& path)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open())
+        die(_("Unable to load image '{}'"), path.string());
+
+    return { std::istreambuf_iterator<char>{ f }, std::istreambuf_iterator<char>{} };
+}
+
+// Decode the image as RGBA, scaled (nearest neighbor) to width x height pixels
+static std::vector<std::uint8_t> load_rgba(const std::filesystem::path& path, const int width, const int height)
+{
+    int            image_width, image_height, channels;
+    unsigned char* img = stbi_load(path.c_str(), &image_width, &image_height, &channels, 4);
+    if (!img)
+        die(_("Unable to load image '{}'"), path.string());
+
+    std::vector<std::uint8_t> ret(static_cast<size_t>(width) * height * 4);
+    for (int y = 0; y < height; ++y)
+    {
+        const int src_y = static_cast<long>(y) * image_height / height;
+        for (int x = 0; x < width; ++x)
+        {
+            const int src_x = static_cast<long>(x) * image_width / width;
+            std::memcpy(&ret[(static_cast<size_t>(y) * width + x) * 4],
+                        &img[(static_cast<size_t>(src_y) * image_width + src_x) * 4], 4);
+        }
+    }
+
+    stbi_image_free(img);
+    return ret;
+}
+
+// https://sw.kovidgoyal.net/kitty/graphics-protocol/
+// PNGs are sent as they are, anything else as raw RGBA already scaled to the cells.
+static std::string encode_kitty(const std::filesystem::path& path, const std::uint32_t id, const std::uint16_t cols,
+                                const std::uint16_t rows, const std::uint16_t cell_width,
+                                const std::uint16_t cell_height)
+{
+    constexpr std::string_view png_signature = "\x89PNG\r\n\x1a\n";
+    constexpr size_t           chunk_size    = 4096;
+
+    std::string data{ read_file(path) };
+    std::string format;
+    if (hasStart(data, png_signature))
+    {
+        format = "f=100";
+    }
+    else
+    {
+        const int                        width  = cols * cell_width;
+        const int                        height = rows * cell_height;
+        const std::vector<std::uint8_t>& rgba   = load_rgba(path, width, height);
+        data.assign(rgba.begin(), rgba.end());
+        format = fmt::format("f=32,s={},v={}", width, height);
+    }
+
+    // a=T: transmit and display, C=1: don't move the cursor, q=2: don't reply
+    const std::string& encoded = base64_encode(data);
+    std::string        ret;
+    ret.reserve(encoded.length() + (encoded.length() / chunk_size + 1) * 16 + 64);
+    for (size_t i = 0; i < encoded.length(); i += chunk_size)
+    {
+        const bool more = i + chunk_size < encoded.length();
+        if (i == 0)
+            ret += fmt::format("\033_Ga=T,{},i={},p=1,c={},r={},C=1,q=2,m={};", format, id, cols, rows, more ? 1 : 0);
+        else
+            ret += fmt::format("\033_Gm={};", more ? 1 : 0);
+
+        ret.append(encoded, i, chunk_size);
+        ret += "\033\\";
+    }
+
+    return ret;
+}
+
+// https://vt100.net/docs/vt3xx-gp/chapter14.html
+// Colors are reduced to a 6x6x6 cube, pixels with alpha < 50% are left transparent.
+static std::string encode_sixel(const std::filesystem::path& path, const std::uint16_t cols, const std::uint16_t rows,
+                                const std::uint16_t cell_width, const std::uint16_t cell_height)
+{
+    const int                        width  = cols * cell_width;
+    const int                        height = rows * cell_height;
+    const std::vector<std::uint8_t>& rgba   = load_rgba(path, width, height);
+
+    // color index of each pixel, -1 for transparent
+    std::vector<std::int16_t> pixels(static_cast<size_t>(width) * height);
+    std::array<bool, 216>     used{};
+    for (size_t i = 0; i < pixels.size(); ++i)
+    {
+        const std::uint8_t* px = &rgba[i * 4];
+        if (px[3] < 128)
+        {
+            pixels[i] = -1;
+            continue;
+        }
+
+        pixels[i]       = ((px[0] * 5 + 127) / 255) * 36 + ((px[1] * 5 + 127) / 255) * 6 + (px[2] * 5 + 127) / 255;
+        used[pixels[i]] = true;
+    }
+
+    // DCS with transparent background, then the raster attributes (1:1 aspect ratio)
+    std::string ret = fmt::format("\033P0;1;0q\"1;1;{};{}", width, height);
+    for (int i = 0; i < 216; ++i)
+        if (used[i])
+            ret += fmt::format("#{};2;{};{};{}", i, i / 36 * 20, i / 6 % 6 * 20, i % 6 * 20);
+
+    // each band is 6 pixels high, and each color of a band is drawn from left to right
+    for (int band = 0; band < height; band += 6)
+    {
+        std::array<bool, 216> band_colors{};
+        for (int y = band; y < std::min(band + 6, height); ++y)
+            for (int x = 0; x < width; ++x)
+                if (pixels[static_cast<size_t>(y) * width + x] >= 0)
+                    band_colors[pixels[static_cast<size_t>(y) * width + x]] = true;
+
+        for (int color = 0; color < 216; ++color)
+        {
+            if (!band_colors[color])
+                continue;
+
+            ret += fmt::format("#{}", color);
+            char   prev = 0;
+            size_t run  = 0;
+            for (int x = 0; x <= width; ++x)
+            {
+                char sixel = 0;
+                if (x < width)
+                {
+                    int bits = 0;
+                    for (int y = band; y < std::min(band + 6, height); ++y)
+                        if (pixels[static_cast<size_t>(y) * width + x] == color)
+                            bits |= 1 << (y - band);
+                    sixel = 63 + bits;
+                }
+
+                if (sixel == prev)
+                {
+                    ++run;
+                    continue;
+                }
+
+                // run-length encode repeated columns
+                if (run > 3)
+                    ret += fmt::format("!{}{}", run, prev);
+                else if (run > 0)
+                    ret.append(run, prev);
+
+                prev = sixel;
+                run  = 1;
+            }
+            ret += '$';
+        }
+        ret += '-';
+    }
+
+    ret += "\033\\";
+    return ret;
+}
+
+// https://iterm2.com/documentation-images.html
+// The terminal decodes and scales the file itself.
+static std::string encode_iterm2(const std::filesystem::path& path, const std::uint16_t cols, const std::uint16_t rows)
+{
+    const std::string& data = read_file(path);
+    return fmt::format("\033]1337;File=inline=1;size={};width={};height={};preserveAspectRatio=1:{}\a", data.length(),
+                       cols, rows, base64_encode(data));
+}
+
+std::string Image::encode(const std::filesystem::path& path, const std::string_view protocol, const std::uint16_t cols,
+                          const std::uint16_t rows, const std::uint16_t cell_width, const std::uint16_t cell_height)
+{
+    std::error_code ec;
+    const auto&     mtime = std::filesystem::last_write_time(path, ec);
+    if (image_cache && image_cache->path == path && image_cache->mtime == mtime && image_cache->protocol == protocol &&
+        image_cache->cols == cols && image_cache->rows == rows && image_cache->cell_width == cell_width &&
+        image_cache->cell_height == cell_height)
+    {
+        Profile::count("cache_hit.image");
+        return image_cache->transmitted ? image_cache->placement : image_cache->payload;
+    }
+
+    Profile::Span span("phase", "image_encode");
+    image_cache.emplace();
+    image_cache->path        = path;
+    image_cache->mtime       = mtime;
+    image_cache->protocol    = protocol;
+    image_cache->cols        = cols;
+    image_cache->rows        = rows;
+    image_cache->cell_width  = cell_width;
+    image_cache->cell_height = cell_height;
+
+    if (protocol == "kitty")
+    {
+        // IDs are shared by the whole terminal window, try to not clash with other programs
+        const std::uint32_t id = 0xCF000000 | (getpid() & 0xFFFFFF);
+
+        image_cache->payload     = encode_kitty(path, id, cols, rows, cell_width, cell_height);
+        image_cache->placement   = fmt::format("\033_Ga=p,i={},p=1,c={},r={},C=1,q=2\033\\", id, cols, rows);
+        image_cache->transmitted = true;
+    }
+    else if (protocol == "sixel")
+    {
+        image_cache->payload = encode_sixel(path, cols, rows, cell_width, cell_height);
+    }
+    else if (protocol == "iterm2")
+    {
+        image_cache->payload = encode_iterm2(path, cols, rows);
+    }
+
+    // save and restore the cursor, sixel and iterm2 move it after the image
+    image_cache->payload = "\0337" + image_cache->payload + "\0338";
+    debug("Image::encode: {} bytes for {} with {}", image_cache->payload.length(), path.string(), protocol);
+    return image_cache->payload;
+}
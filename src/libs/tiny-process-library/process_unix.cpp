@@ -208,6 +208,13 @@ Process::id_type Process::open(const std::function<void()> &function) noexcept {
     }
 
     setpgid(0, 0);
+
+    // The signal mask survives exec, and customfetch blocks SIGINT/SIGTERM
+    // in live and daemon mode (for their signalfd): don't pass it to the command
+    sigset_t empty_mask;
+    sigemptyset(&empty_mask);
+    sigprocmask(SIG_SETMASK, &empty_mask, nullptr);
+
     // TODO: See here on how to emulate tty for colors: http://stackoverflow.com/questions/1401002/trick-an-application-into-thinking-its-stdin-is-interactive-not-a-pipe
     // TODO: One solution is: echo "command;exit"|script -q /dev/null
 
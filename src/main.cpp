@@ -25,26 +25,44 @@
 
 #include <dlfcn.h>
 #include <stdlib.h>
+#include <sys/ioctl.h>
 #include <termios.h>
 #include <unistd.h>
 
+#include "platform.hpp"
+#if CF_LINUX || CF_ANDROID
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+
+#include <csignal>
+#endif
+
 #include <algorithm>
+#include <array>
 #include <cerrno>
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
 #include <filesystem>
+#include <fstream>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "core-modules.hh"
+#include "daemon.hpp"
 #include "display.hpp"
 #include "fmt/base.h"
 #include "fmt/ranges.h"
 #include "getopt_port/getopt.h"
 #include "gui.hpp"
 #include "libcufetch/fmt/compile.h"
-#include "platform.hpp"
+#include "profile.hpp"
+#include "snapshot.hpp"
 #include "switch_fnv1a.hpp"
 #include "texts.hpp"
 #include "util.hpp"
@@ -69,6 +87,9 @@ using namespace std::string_view_literals;
 
 bool display_modules    = false;
 bool display_list_logos = false;
+bool daemon_mode        = false;
+bool snapshot_mode      = false;
+bool snapshot_disabled  = false;
 
 struct termios orig_termios;
 
@@ -87,6 +108,499 @@ static void enable_raw_mode()
     tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
 }
 
+// Get the path of the logo to display from source-path, --distro and ascii-logo-type.
+// If there's none, the fallback logo is written to a temporary file.
+static std::string get_logo_path(Config& config)
+{
+    if (config.source_path.empty() || config.source_path == "off")
+        config.args_disable_source = true;
+
+    config.m_display_distro = (config.source_path == "os");
+
+    std::string path = config.m_display_distro ? Display::detect_distro(config) : config.source_path;
+
+    if (!config.ascii_logo_type.empty() && config.m_display_distro)
+    {
+        std::string  logo_type_path{ path };
+        const size_t pos = path.rfind('.');
+
+        if (pos != std::string::npos)
+            logo_type_path.insert(pos, "_" + config.ascii_logo_type);
+        else
+            logo_type_path += "_" + config.ascii_logo_type;
+
+        if (std::filesystem::exists(logo_type_path))
+            path = logo_type_path;
+    }
+
+    debug("{} path = {}", __PRETTY_FUNCTION__, path);
+
+    if (!std::filesystem::exists(path) && !config.args_disable_source)
+    {
+        path                   = std::filesystem::temp_directory_path() / "customfetch_ascii_logo-XXXXXX";
+        Display::ascii_logo_fd = mkstemp(path.data());
+        if (Display::ascii_logo_fd < 0)
+            die("Failed to create temp path at {}: {}", path, strerror(errno));
+        write(Display::ascii_logo_fd, ascii_logo.data(), ascii_logo.size());
+    }
+
+    return path;
+}
+
+// shown in live mode by pressing 's'
+static bool show_module_stats = false;
+
+// Render a frame in live mode, with the modules statistics below it if enabled
+static std::vector<std::string> render_live_frame(const Config& config, const std::string& path,
+                                                  const moduleMap_t& moduleMap)
+{
+    std::vector<std::string> frame = Display::render(config, false, path, moduleMap);
+    if (!show_module_stats)
+        return frame;
+
+    // only the slowest ones, or it won't fit in the terminal
+    const std::vector<module_stats_t>& stats = cfGetModuleStats();
+    frame.emplace_back("");
+    frame.push_back(fmt::format("{}{:<32} {:>8} {:>10} {:>10} {:>10}{}", NOCOLOR_BOLD, "module", "calls", "avg ms",
+                                "max ms", "bytes", NOCOLOR));
+    for (size_t i = 0; i < stats.size() && i < 10; ++i)
+        frame.push_back(fmt::format("{:<32} {:>8} {:>10.3f} {:>10.3f} {:>10}", stats[i].name, stats[i].calls,
+                                    stats[i].total_ns / 1e6 / stats[i].calls, stats[i].max_ns / 1e6,
+                                    stats[i].bytes));
+
+    return frame;
+}
+
+#if CF_LINUX || CF_ANDROID
+// Files watched in live mode for reloading them when they change.
+// We watch their directories, because editors usually save by writing a new file and renaming it over the old one.
+struct live_watches_t
+{
+    int                   fd = -1;
+    int                   config_wd = -1, logo_wd = -1, data_wd = -1;
+    std::filesystem::path config_file, logo_file, data_dir;
+};
+
+// (Re)add the watches for the config file, the logo file and the ascii logos in the data dir
+static void update_live_watches(live_watches_t& watches, const Config& config, const std::string& path)
+{
+    for (const int wd : { watches.config_wd, watches.logo_wd, watches.data_wd })
+        if (wd >= 0)
+            inotify_rm_watch(watches.fd, wd);
+
+    constexpr std::uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE;
+    watches.logo_file = path;
+    watches.data_dir  = std::filesystem::path(config.data_dir) / "ascii";
+    watches.config_wd = inotify_add_watch(watches.fd, watches.config_file.parent_path().c_str(), mask);
+    watches.data_wd   = inotify_add_watch(watches.fd, watches.data_dir.c_str(), mask);
+
+    // the fallback logo is in a temporary file, already deleted after being read
+    watches.logo_wd = -1;
+    if (!config.args_disable_source && !hasStart(watches.logo_file.filename().string(), "customfetch_ascii_logo-"))
+        watches.logo_wd = inotify_add_watch(watches.fd, watches.logo_file.parent_path().c_str(), mask);
+}
+
+// Read the pending inotify events, and check if the config or the logo changed
+static void read_live_watches(const live_watches_t& watches, bool& config_changed, bool& logo_changed)
+{
+    alignas(struct inotify_event) char buf[4096];
+    ssize_t                            len;
+    while ((len = read(watches.fd, buf, sizeof(buf))) > 0)
+    {
+        for (char* ptr = buf; ptr < buf + len;)
+        {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(ptr);
+            const std::string_view      name  = event->len > 0 ? event->name : "";
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            if (event->wd == watches.config_wd && name == watches.config_file.filename().string())
+                config_changed = true;
+            if ((event->wd == watches.logo_wd && name == watches.logo_file.filename().string()) ||
+                event->wd == watches.data_wd)
+                logo_changed = true;
+        }
+    }
+}
+
+// Load again what changed on disk, keeping the plugins and the modules caches.
+// Only what's computed from the changed config values is thrown away.
+static void live_reload(Config& config, const std::filesystem::path& configFile, std::string& path,
+                        const bool config_changed, const bool logo_changed)
+{
+    const Config::reload_t reload = config_changed ? config.reloadConfigFile(configFile) : Config::RELOAD_UNCHANGED;
+
+    // the layout lines are compared with their cached ones at every render,
+    // and the logo is parsed again when its file is modified.
+    // But colors and the others options are used in both
+    if (reload == Config::RELOAD_ALL)
+        Display::reset_caches();
+
+    // set by core_plugins_start(), the cpu usage modules may be used for the first time after the reload
+    cpu_usage_first_sample_ms = config.cpu_usage_sample_ms;
+
+    // the logo to display may be another one now
+    if (reload == Config::RELOAD_ALL || logo_changed)
+        path = get_logo_path(config);
+}
+
+// Live mode loop, waiting on:
+// * a timerfd for the ticks, so they don't drift by the time spent rendering
+// * stdin, for quitting as soon as 'q' is pressed, and toggling the modules statistics with 's'
+// * a signalfd, for redrawing on terminal resize (SIGWINCH) and exiting cleanly on SIGINT/SIGTERM
+// * an inotify fd, for reloading the config and the logo when they're modified
+static void live_loop(Config& config, const std::filesystem::path& configFile, std::string& path,
+                      const moduleMap_t& moduleMap)
+{
+    sigset_t mask, old_mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGWINCH);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    // the commands we run get an empty mask back, in TinyProcessLib::Process
+    sigprocmask(SIG_BLOCK, &mask, &old_mask);
+
+    const int sig_fd   = signalfd(-1, &mask, SFD_CLOEXEC);
+    const int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    const int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (sig_fd < 0 || timer_fd < 0 || epoll_fd < 0)
+        die("Failed to setup the live mode loop: {}", strerror(errno));
+
+    // not a big deal if it fails, we just won't reload anything
+    live_watches_t watches;
+    watches.fd          = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    watches.config_file = configFile;
+    if (watches.fd >= 0)
+        update_live_watches(watches, config, path);
+
+    // first tick right away, then every loop_ms
+    struct itimerspec its{};
+    its.it_value.tv_nsec    = 1;
+    its.it_interval.tv_sec  = config.loop_ms / 1000;
+    its.it_interval.tv_nsec = (config.loop_ms % 1000) * 1000000L;
+    timerfd_settime(timer_fd, 0, &its, NULL);
+
+    struct epoll_event ev{};
+    ev.events  = EPOLLIN;
+    ev.data.fd = timer_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev);
+    ev.data.fd = sig_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sig_fd, &ev);
+    // fails if stdin is a regular file, we just won't listen for keys then
+    ev.data.fd = STDIN_FILENO;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, STDIN_FILENO, &ev);
+    if (watches.fd >= 0)
+    {
+        ev.data.fd = watches.fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, watches.fd, &ev);
+    }
+
+    bool running = true;
+    while (running)
+    {
+        struct epoll_event events[4];
+        const int          n = epoll_wait(epoll_fd, events, 4, -1);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            die("epoll_wait() failed: {}", strerror(errno));
+
+        bool                                  redraw = false, config_changed = false, logo_changed = false;
+        std::chrono::steady_clock::time_point changed_at;
+        for (int i = 0; i < n; ++i)
+        {
+            const int fd = events[i].data.fd;
+            if (fd == timer_fd)
+            {
+                // if rendering took longer than loop_ms, we just skip the missed ticks
+                std::uint64_t expirations;
+                read(timer_fd, &expirations, sizeof(expirations));
+                redraw = true;
+            }
+            else if (fd == sig_fd)
+            {
+                struct signalfd_siginfo info;
+                if (read(sig_fd, &info, sizeof(info)) != sizeof(info))
+                    continue;
+
+                if (info.ssi_signo == SIGWINCH)
+                {
+                    Display::reset_frame();
+                    redraw = true;
+                }
+                else
+                {
+                    running = false;
+                }
+            }
+            else if (fd == STDIN_FILENO)
+            {
+                char          buf[64];
+                const ssize_t len = read(STDIN_FILENO, buf, sizeof(buf));
+                if (len <= 0)
+                {
+                    // EOF, stop listening or we'll wake up forever
+                    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, STDIN_FILENO, NULL);
+                    continue;
+                }
+
+                if (std::find_if(buf, buf + len, [](const char c) { return c == 'q' || c == 'Q'; }) != buf + len)
+                    running = false;
+
+                if (std::find_if(buf, buf + len, [](const char c) { return c == 's' || c == 'S'; }) != buf + len)
+                {
+                    show_module_stats = !show_module_stats;
+                    redraw            = true;
+                }
+            }
+            else if (fd == watches.fd)
+            {
+                changed_at = std::chrono::steady_clock::now();
+                read_live_watches(watches, config_changed, logo_changed);
+            }
+        }
+
+        if (!running)
+        {
+            info("exiting...\n");
+            break;
+        }
+
+        if (config_changed || logo_changed)
+        {
+            live_reload(config, configFile, path, config_changed, logo_changed);
+            update_live_watches(watches, config, path);
+            redraw = true;
+        }
+
+        if (redraw)
+        {
+            // with wrapped lines we can't know on which row each line starts,
+            // so clear the screen and draw everything again
+            Display::display(render_live_frame(config, path, moduleMap), !config.wrap_lines, config.wrap_lines);
+        }
+
+        if (config_changed || logo_changed)
+            debug("live mode: new frame {:.2f} ms after the change",
+                  std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - changed_at).count());
+    }
+
+    if (watches.fd >= 0)
+        close(watches.fd);
+    close(epoll_fd);
+    close(timer_fd);
+    close(sig_fd);
+    sigprocmask(SIG_SETMASK, &old_mask, NULL);
+}
+
+// The bytes that Display::display() writes for a frame, out of live mode
+static std::string compose_frame(const Config& config, const std::vector<std::string>& lines)
+{
+    std::string frame;
+    if (!config.wrap_lines)
+        frame = "\x1B[?25l\x1B[?7l";
+
+    for (const std::string& line : lines)
+    {
+        frame += line;
+        frame += '\n';
+    }
+
+    if (!config.wrap_lines)
+        frame += "\x1B[?25h\x1B[?7h";
+
+    return frame;
+}
+
+// images are drawn straight to the terminal, so the daemon can't send them
+static void check_daemon_logo(const Config& config, const std::string& path)
+{
+    if (config.args_disable_source)
+        return;
+
+    std::array<unsigned char, 32> buffer{};
+    std::ifstream                 f(path, std::ios::binary);
+    f.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    if (is_file_image(buffer.data()))
+        die(_("Images can't be used as logo in daemon mode"));
+}
+
+// Whether the layout or the logo use modules from the terminal session (e.g $<user.terminal.name>),
+// which would be the ones of the daemon instead of the ones of each client
+static bool uses_session_modules(const Config& config, const std::string& path)
+{
+    std::string text;
+    for (const std::string& line : config.args_layout.empty() ? config.layout : config.args_layout)
+        text += line;
+
+    if (!config.args_disable_source)
+    {
+        std::ifstream f(path, std::ios::binary);
+        text.append(std::istreambuf_iterator<char>{ f }, std::istreambuf_iterator<char>{});
+    }
+
+    for (size_t pos = text.find("$<"); pos != text.npos; pos = text.find("$<", pos + 2))
+        if (is_module_per_session(std::string_view(text).substr(pos + 2, text.find_first_of("(>", pos + 2) - (pos + 2))))
+            return true;
+
+    return false;
+}
+
+// Daemon mode loop, waiting on:
+// * the unix socket, for sending the last rendered frame to the clients
+// * a timerfd, for refreshing the frame, where each layout line is parsed again only when due like in live mode
+// * a signalfd, for exiting cleanly on SIGINT/SIGTERM
+// * an inotify fd, for reloading the config and the logo when they're modified
+static void daemon_loop(Config& config, const std::filesystem::path& configFile, std::string& path,
+                        const moduleMap_t& moduleMap)
+{
+    sigset_t mask, old_mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    // the commands we run get an empty mask back, in TinyProcessLib::Process
+    sigprocmask(SIG_BLOCK, &mask, &old_mask);
+
+    const std::filesystem::path& socket_path = Daemon::get_socket_path();
+    const std::filesystem::path& config_path = std::filesystem::weakly_canonical(configFile);
+    const int                    listen_fd   = Daemon::listen_socket(socket_path);
+    const int                    sig_fd      = signalfd(-1, &mask, SFD_CLOEXEC);
+    const int                    timer_fd    = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    const int                    epoll_fd    = epoll_create1(EPOLL_CLOEXEC);
+    if (sig_fd < 0 || timer_fd < 0 || epoll_fd < 0)
+        die("Failed to setup the daemon loop: {}", strerror(errno));
+
+    live_watches_t watches;
+    watches.fd          = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    watches.config_file = configFile;
+    if (watches.fd >= 0)
+        update_live_watches(watches, config, path);
+
+    // refresh every --loop-ms, or every second by default
+    const unsigned int refresh_ms = (config.loop_ms >= 200) ? config.loop_ms : 1000;
+    struct itimerspec  its{};
+    its.it_value.tv_sec  = refresh_ms / 1000;
+    its.it_value.tv_nsec = (refresh_ms % 1000) * 1000000L;
+    its.it_interval      = its.it_value;
+    timerfd_settime(timer_fd, 0, &its, NULL);
+
+    struct epoll_event ev{};
+    ev.events = EPOLLIN;
+    for (const int fd : { listen_fd, timer_fd, sig_fd, watches.fd })
+    {
+        ev.data.fd = fd;
+        if (fd >= 0)
+            epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    // the last rendered frame, and the terminal width it was rendered for.
+    // The width matters only with a percentage offset, so usually it's rendered only at the ticks.
+    std::string   frame;
+    std::uint16_t frame_columns = 80;
+    const auto    render_frame  = [&](const std::uint16_t columns) {
+        Display::columns = columns;
+        frame            = compose_frame(config, Display::render(config, false, path, moduleMap));
+        frame_columns    = columns;
+    };
+
+    // the clients render such layouts by themselves
+    const auto check_session_modules = [&]() {
+        const bool ret = uses_session_modules(config, path);
+        if (ret)
+            warn(_("The layout or the logo use modules from the terminal session (user.terminal, user.shell, user.wm "
+                   "or user.de), the clients will render it by themselves"));
+        return ret;
+    };
+
+    check_daemon_logo(config, path);
+    bool session_layout = check_session_modules();
+    render_frame(frame_columns);
+    info(_("customfetch daemon listening on '{}'"), socket_path.string());
+
+    bool running = true;
+    while (running)
+    {
+        struct epoll_event events[4];
+        const int          n = epoll_wait(epoll_fd, events, 4, -1);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            die("epoll_wait() failed: {}", strerror(errno));
+
+        bool redraw = false, config_changed = false, logo_changed = false;
+        for (int i = 0; i < n; ++i)
+        {
+            const int fd = events[i].data.fd;
+            if (fd == timer_fd)
+            {
+                std::uint64_t expirations;
+                read(timer_fd, &expirations, sizeof(expirations));
+                redraw = true;
+            }
+            else if (fd == sig_fd)
+            {
+                // consume it, or it will be delivered when unblocked
+                struct signalfd_siginfo info;
+                read(sig_fd, &info, sizeof(info));
+                running = false;
+            }
+            else if (fd == watches.fd)
+            {
+                read_live_watches(watches, config_changed, logo_changed);
+            }
+            else if (fd == listen_fd)
+            {
+                Daemon::request_t request;
+                const int         client_fd = Daemon::accept_request(listen_fd, request);
+                if (client_fd < 0)
+                    continue;
+
+                // colors can be removed from the frame, but not added back
+                if (session_layout || std::filesystem::weakly_canonical(request.config_file) != config_path ||
+                    (!request.no_color && config.args_disable_colors))
+                {
+                    Daemon::send_frame(client_fd, false);
+                    continue;
+                }
+
+                if (request.columns > 0 && request.columns != frame_columns && config.offset.back() == '%')
+                    render_frame(request.columns);
+
+                if (request.no_color && !config.args_disable_colors)
+                    Daemon::send_frame(client_fd, true, Daemon::strip_colors(frame));
+                else
+                    Daemon::send_frame(client_fd, true, frame);
+            }
+        }
+
+        if (!running)
+        {
+            info("exiting...\n");
+            break;
+        }
+
+        if (config_changed || logo_changed)
+        {
+            live_reload(config, configFile, path, config_changed, logo_changed);
+            update_live_watches(watches, config, path);
+            check_daemon_logo(config, path);
+            session_layout = check_session_modules();
+            redraw = true;
+        }
+
+        if (redraw)
+            render_frame(frame_columns);
+    }
+
+    unlink(socket_path.c_str());
+    if (watches.fd >= 0)
+        close(watches.fd);
+    close(listen_fd);
+    close(epoll_fd);
+    close(timer_fd);
+    close(sig_fd);
+    sigprocmask(SIG_SETMASK, &old_mask, NULL);
+}
+#else
 static int kbhit()
 {
     struct timeval tv = { 0L, 0L };
@@ -97,6 +611,192 @@ static int kbhit()
     return select(STDIN_FILENO + 1, &fds, NULL, NULL, &tv) > 0;
 }
 
+static void live_loop(Config& config, const std::filesystem::path& configFile, std::string& path,
+                      const moduleMap_t& moduleMap)
+{
+    const std::chrono::milliseconds sleep_ms{ config.loop_ms };
+
+    while (true)
+    {
+        if (kbhit())
+        {
+            char c;
+            read(STDIN_FILENO, &c, 1);
+            if (c == 'q' || c == 'Q')
+            {
+                info("exiting...\n");
+                break;
+            }
+            else if (c == 's' || c == 'S')
+            {
+                show_module_stats = !show_module_stats;
+            }
+        }
+
+        // with wrapped lines we can't know on which row each line starts,
+        // so clear the screen and draw everything again
+        Display::display(render_live_frame(config, path, moduleMap), !config.wrap_lines, config.wrap_lines);
+        std::this_thread::sleep_for(sleep_ms);
+    }
+}
+
+static void daemon_loop(Config&, const std::filesystem::path&, std::string&, const moduleMap_t&)
+{
+    die(_("The daemon mode isn't supported on this platform"));
+}
+#endif
+
+// There is a snapshot for each config file, named after its canonical path (like the config cache)
+static std::filesystem::path get_snapshot_path(const std::filesystem::path& configFile)
+{
+    std::error_code ec;
+    std::string     path = std::filesystem::weakly_canonical(configFile, ec).string();
+    if (ec)
+        path = std::filesystem::absolute(configFile).string();
+
+    return getCacheDir() / fmt::format("snapshot-{:016x}", fnv1a64::hash(path.data(), path.length()));
+}
+
+// Load the snapshot of the modules output, which is valid only in the same boot,
+// with the same config, options and plugins (and customfetch version)
+static void load_snapshot(const std::filesystem::path& snapshot_path, const Config& config, int argc, char* argv[],
+                          const std::filesystem::path& configFile, const std::vector<std::filesystem::path>& plugins)
+{
+    // the expiration times are from the boot time clock, which starts again at each boot
+    const std::string& boot_id = read_by_syspath("/proc/sys/kernel/random/boot_id");
+    if (boot_id == UNKNOWN || boot_id.empty())
+    {
+        debug("snapshot: can't get the boot ID, not using it");
+        return;
+    }
+
+    std::ifstream     f(configFile, std::ios::binary);
+    const std::string config_str{ std::istreambuf_iterator<char>{ f }, std::istreambuf_iterator<char>{} };
+
+    std::string args;
+    for (int i = 1; i < argc; ++i)
+    {
+        // these don't change the output
+        if (hasStart(argv[i], "--snapshot") || hasStart(argv[i], "--profile"))
+            continue;
+        args += argv[i];
+        args += '\0';
+    }
+
+    std::string plugins_str;
+    for (const std::filesystem::path& plugin : plugins)
+    {
+        std::error_code ec;
+        plugins_str += fmt::format("{}:{}\n", plugin.string(),
+                                   std::filesystem::last_write_time(plugin, ec).time_since_epoch().count());
+    }
+
+    const std::hash<std::string> hash;
+    const std::string&           key = fmt::format("{}\n{}\n{:x}\n{:x}\n{:x}", VERSION, boot_id, hash(config_str),
+                                                   hash(args), hash(plugins_str));
+
+    // modules from the terminal session can change at each run,
+    // the others are kept as long as their interval in [live-intervals]
+    Snapshot::load(
+        snapshot_path, key,
+        [&config](const std::string_view module) {
+            return is_module_per_session(module) ? std::chrono::milliseconds(0)
+                                                 : Display::get_module_interval(config, module);
+        },
+        snapshot_mode);
+}
+
+// customfetch --client: print the frame rendered by the daemon.
+// Only if there are no other options than these, since the daemon renders with its own.
+static bool render_from_daemon(int argc, char* argv[], const std::filesystem::path& configFile)
+{
+    Daemon::request_t request;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (arg == "-N" || arg == "--no-color")
+            request.no_color = true;
+        else if (arg == "-C" || arg == "--config")
+            ++i;
+        else if (arg != "--client" && !hasStart(arg, "--config=") && !hasStart(arg, "-C"))
+            return false;
+    }
+
+    const char* no_color = std::getenv("NO_COLOR");
+    if (no_color != NULL && no_color[0] != '\0')
+        request.no_color = true;
+
+    struct winsize win{};
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &win) == 0)
+        request.columns = win.ws_col;
+
+    std::error_code ec;
+    request.config_file = std::filesystem::weakly_canonical(configFile, ec);
+
+    std::string frame;
+    if (ec || !Daemon::request_frame(request, frame))
+    {
+        debug("the daemon isn't running or can't be used, rendering here");
+        return false;
+    }
+
+    fwrite(frame.data(), 1, frame.size(), stdout);
+    return true;
+}
+
+// Get the root modules of each plugin library (e.g "github" for $<github.followers>),
+// from the index generated by cufetchpm
+static std::unordered_map<std::string, std::vector<std::string>> read_plugin_index(const std::filesystem::path& path)
+{
+    std::unordered_map<std::string, std::vector<std::string>> ret;
+    std::ifstream                                             f(path);
+    std::string                                               line;
+    while (std::getline(f, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::vector<std::string> fields = split(line, '\t');
+        std::string              library{ std::move(fields.front()) };
+        fields.erase(fields.begin());
+        ret.emplace(std::move(library), std::move(fields));
+    }
+
+    return ret;
+}
+
+static void add_module_prefixes(const std::string_view text, std::unordered_set<std::string>& prefixes)
+{
+    for (size_t pos = text.find("$<"); pos != text.npos; pos = text.find("$<", pos + 2))
+        prefixes.emplace(text.substr(pos + 2, text.find_first_of(".(>", pos + 2) - (pos + 2)));
+}
+
+// Get the root modules used in the layout and in the logo, e.g "$<github.followers>" -> "github"
+static std::unordered_set<std::string> get_layout_prefixes(const Config& config)
+{
+    std::unordered_set<std::string> ret;
+    for (const std::string& line : config.args_layout.empty() ? config.layout : config.args_layout)
+        add_module_prefixes(line, ret);
+
+    // The logo of the detected distro can only be known after the core modules are started,
+    // only the ones from source-path and --distro are known here (the logos in assets/ascii don't use modules)
+    std::string logo_path;
+    if (config.args_disable_source || config.source_path.empty() || config.source_path == "off")
+        return ret;
+    else if (config.source_path != "os")
+        logo_path = config.source_path;
+    else if (!config.args_custom_distro.empty())
+        logo_path = Display::detect_distro(config);
+
+    std::ifstream f(logo_path, std::ios::binary);
+    std::string   logo{ std::istreambuf_iterator<char>{ f }, std::istreambuf_iterator<char>{} };
+    logo.resize(std::max<size_t>(logo.size(), 32));
+    if (!is_file_image(reinterpret_cast<const unsigned char*>(logo.data())))
+        add_module_prefixes(logo, ret);
+
+    return ret;
+}
+
 // Print the version and some other infos, then exit successfully
 static void version()
 {
@@ -281,6 +981,11 @@ static bool parseargs(int argc, char* argv[], Config& config, const std::filesys
 
         {"list-logos",           no_argument,       0, "list-logos"_fnv1a16},
         {"disallow-command-tag", no_argument,       0, "disallow-command-tag"_fnv1a16},
+        {"rebuild-cache",        no_argument,       0, "rebuild-cache"_fnv1a16},
+        {"profile",              optional_argument, 0, "profile"_fnv1a16},
+        {"daemon",               no_argument,       0, "daemon"_fnv1a16},
+        {"client",               no_argument,       0, "client"_fnv1a16},
+        {"snapshot",             optional_argument, 0, "snapshot"_fnv1a16},
         {"sep-reset-after",      optional_argument, 0, "sep-reset-after"_fnv1a16},
         {"debug",                optional_argument, 0, "debug"_fnv1a16},
         {"wrap-lines",           optional_argument, 0, "wrap-lines"_fnv1a16},
@@ -319,6 +1024,16 @@ static bool parseargs(int argc, char* argv[], Config& config, const std::filesys
                 explain_how_this_works(); break;
             case "list-logos"_fnv1a16:
                 display_list_logos = true; break;
+            case "daemon"_fnv1a16:
+                daemon_mode = true; break;
+            case "client"_fnv1a16: // already tried in main(), the daemon couldn't be used
+                break;
+            case "snapshot"_fnv1a16:
+                if (OPTIONAL_ARGUMENT_IS_PRESENT && !str_to_bool(optarg))
+                    snapshot_disabled = true;
+                else
+                    snapshot_mode = true;
+                break;
             case 'f':
                 config.overrideOption("gui.font", optarg); break;
             case 'o':
@@ -351,6 +1066,9 @@ static bool parseargs(int argc, char* argv[], Config& config, const std::filesys
             case "disallow-command-tag"_fnv1a16:
                 config.args_disallow_commands = true; break;
 
+            case "rebuild-cache"_fnv1a16:
+                config.args_rebuild_cache = true; break;
+
             case "logo-padding-top"_fnv1a16:
                 config.overrideOption("config.logo-padding-top", std::stoi(optarg)); break;
 
@@ -406,6 +1124,13 @@ static bool parseargs(int argc, char* argv[], Config& config, const std::filesys
                     config.overrideOption("config.sep-reset-after", true);
                 break;
 
+            case "profile"_fnv1a16:
+                if (OPTIONAL_ARGUMENT_IS_PRESENT)
+                    Profile::enable(optarg);
+                else
+                    Profile::enable(getCacheDir() / "profile.json");
+                break;
+
             default:
                 return false;
         }
@@ -450,6 +1175,10 @@ int main(int argc, char* argv[])
     const std::filesystem::path& configDir  = getConfigDir();
     const std::filesystem::path& configFile = parse_config_path(argc, argv, configDir);
 
+    if (std::any_of(argv + 1, argv + argc, [](const std::string_view arg) { return arg == "--client"; }) &&
+        render_from_daemon(argc, argv, configFile))
+        return 0;
+
     localize();
 
     Config config(configFile, configDir);
@@ -457,15 +1186,37 @@ int main(int argc, char* argv[])
         return 1;
     config.loadConfigFile(configFile);
 
-    std::vector<void*>          plugins_handle;
+    std::vector<void*>                 plugins_handle;
+    std::vector<std::filesystem::path> plugins_path;
     const std::filesystem::path pluginDir = configDir / "plugins";
     std::filesystem::create_directories(pluginDir);
+
+    // Load only the plugins that have modules in the layout.
+    // Those not in the index (not installed with cufetchpm) are always loaded,
+    // and all of them when listing the modules or in live and daemon mode, where the config can be reloaded.
+    const bool  load_all_plugins = display_modules || daemon_mode || config.loop_ms >= 200;
+    const auto& plugin_index     = read_plugin_index(pluginDir / "index");
+    const auto& layout_prefixes  = get_layout_prefixes(config);
     for (const auto& entry : std::filesystem::recursive_directory_iterator{ pluginDir })
     {
         if (entry.is_regular_file() && entry.path().has_extension() && entry.path().extension() == LIBRARY_EXTENSION){}
         else {continue;}
 
+        if (!load_all_plugins)
+        {
+            const auto& it = plugin_index.find(std::filesystem::absolute(entry.path()).string());
+            if (it != plugin_index.end() &&
+                std::none_of(it->second.begin(), it->second.end(),
+                             [&](const std::string& prefix) { return layout_prefixes.count(prefix) > 0; }))
+            {
+                debug("skipping plugin at {}, none of its modules are in the layout or logo", entry.path().string());
+                continue;
+            }
+        }
+
         debug("loading plugin at {}!", entry.path().string());
+        const std::string& plugin_name = entry.path().filename().string();
+        Profile::Span      span("plugin", plugin_name);
 
         void* handle = LOAD_LIBRARY(std::filesystem::absolute(entry.path()).c_str());
         if (!handle)
@@ -486,11 +1237,14 @@ int main(int argc, char* argv[])
 
         start(handle, config);
         plugins_handle.push_back(handle);
+        plugins_path.push_back(entry.path());
     }
 
     // The "conflicting" modules won't be overwritten by the main ones.
     // First the external modules, then the core ones.
+    Profile::Span span_core("phase", "core_plugins_start");
     core_plugins_start(config);
+    span_core.end();
 
     if (display_modules)
     {
@@ -516,39 +1270,10 @@ int main(int argc, char* argv[])
         moduleMap.emplace(module.name, module);
     }
 
-    is_live_mode = (config.loop_ms >= 200);
-
-    if (config.source_path.empty() || config.source_path == "off")
-        config.args_disable_source = true;
-
-    config.m_display_distro = (config.source_path == "os");
-
-    std::string path = config.m_display_distro ? Display::detect_distro(config) : config.source_path;
-
-    if (!config.ascii_logo_type.empty() && config.m_display_distro)
-    {
-        std::string  logo_type_path{ path };
-        const size_t pos = path.rfind('.');
-
-        if (pos != std::string::npos)
-            logo_type_path.insert(pos, "_" + config.ascii_logo_type);
-        else
-            logo_type_path += "_" + config.ascii_logo_type;
-
-        if (std::filesystem::exists(logo_type_path))
-            path = logo_type_path;
-    }
-
-    debug("{} path = {}", __PRETTY_FUNCTION__, path);
+    // the daemon also keeps the rendered layout lines until their modules are due
+    is_live_mode = (config.loop_ms >= 200) || daemon_mode;
 
-    if (!std::filesystem::exists(path) && !config.args_disable_source)
-    {
-        path                   = std::filesystem::temp_directory_path() / "customfetch_ascii_logo-XXXXXX";
-        Display::ascii_logo_fd = mkstemp(path.data());
-        if (Display::ascii_logo_fd < 0)
-            die("Failed to create temp path at {}: {}", path, strerror(errno));
-        write(Display::ascii_logo_fd, ascii_logo.data(), ascii_logo.size());
-    }
+    std::string path = get_logo_path(config);
 
 #if GUI_APP
     const auto& app = Gtk::Application::create("org.toni.customfetch");
@@ -556,49 +1281,45 @@ int main(int argc, char* argv[])
     return app->run(window);
 #endif  // GUI_APP
 
-    if (!config.wrap_lines)
+    // the daemon sends these along with the frames
+    if (!config.wrap_lines && !daemon_mode)
     {
         // https://en.cppreference.com/w/c/program/exit
         std::atexit(enable_cursor);
 
-        // hide cursor and disable line wrapping
-        fmt::print("\x1B[?25l\x1B[?7l");
+        // hide cursor and disable line wrapping, along with the first frame
+        Display::frame_prefix = "\x1B[?25l\x1B[?7l";
     }
 
-    if (is_live_mode)
+    if (daemon_mode)
     {
+        daemon_loop(config, configFile, path, moduleMap);
+    }
+    else if (is_live_mode)
+    {
+        // for the overlay toggled with 's'
+        cfEnableModuleStats(true);
         enable_raw_mode();
-        const std::chrono::milliseconds sleep_ms{ config.loop_ms };
-
-        while (true)
-        {
-            if (kbhit())
-            {
-                char c;
-                read(STDIN_FILENO, &c, 1);
-                if (c == 'q' || c == 'Q')
-                {
-                    info("exiting...\n");
-                    disable_raw_mode();
-                    break;
-                }
-            }
-
-            // clear screen and go to position 0, 0
-            write(STDOUT_FILENO, "\33[H\33[2J", 7);
-            fmt::print("\033[0;0H");
-
-            Display::display(Display::render(config, false, path, moduleMap));
-            std::this_thread::sleep_for(sleep_ms);
-        }
+        live_loop(config, configFile, path, moduleMap);
+        disable_raw_mode();
     }
     else
     {
+        // once created with --snapshot, it's used and kept updated by every run with the same config,
+        // until it's removed with --snapshot=false
+        const std::filesystem::path& snapshot_path = get_snapshot_path(configFile);
+        std::error_code              ec;
+        if (snapshot_disabled)
+            std::filesystem::remove(snapshot_path, ec);
+        else if (snapshot_mode || std::filesystem::exists(snapshot_path))
+            load_snapshot(snapshot_path, config, argc, argv, configFile, plugins_path);
+
         Display::display(Display::render(config, false, path, moduleMap));
+        Snapshot::save();
     }
 
     // enable both of them again
-    if (!config.wrap_lines)
+    if (!config.wrap_lines && !daemon_mode)
         enable_cursor();
 
     core_plugins_finish();
@@ -46,7 +46,9 @@
 #include "fmt/ranges.h"
 #include "pci.ids.hpp"
 #include "platform.hpp"
+#include "profile.hpp"
 #include "tiny-process-library/process.hpp"
+#include "unicode_width.hpp"
 
 bool hasEnding(const std::string_view fullString, const std::string_view ending)
 {
@@ -81,6 +83,69 @@ void ctrl_d_handler(const std::istream& cin)
         die(_("Exiting due to CTRL-D or EOF"));
 }
 
+static size_t get_codepoint_width(const std::uint32_t codepoint)
+{
+    // nothing is zero-width or wide before the combining diacritical marks
+    if (codepoint < 0x300)
+        return 1;
+
+    // CJK Unified Ideographs, the most common wide characters
+    if (codepoint >= 0x4E00 && codepoint <= 0x9FFF)
+        return 2;
+
+    const auto& it = std::upper_bound(unicode_width_ranges.begin(), unicode_width_ranges.end(), codepoint,
+                                      [](const std::uint32_t cp, const unicode_range_t& range) { return cp < range.first; });
+    if (it != unicode_width_ranges.begin() && codepoint <= std::prev(it)->last)
+        return std::prev(it)->width;
+
+    return 1;
+}
+
+size_t get_display_width(const std::string_view str)
+{
+    // fast path: skip the ASCII part 8 bytes at a time, it's usually all of it
+    size_t i = 0;
+    for (; i + sizeof(std::uint64_t) <= str.length(); i += sizeof(std::uint64_t))
+    {
+        std::uint64_t chunk;
+        std::memcpy(&chunk, str.data() + i, sizeof(chunk));
+        if (chunk & 0x8080808080808080ULL)
+            break;
+    }
+
+    size_t width = i;
+    while (i < str.length())
+    {
+        const unsigned char c = str[i];
+        if (c < 0x80)
+        {
+            ++width;
+            ++i;
+            continue;
+        }
+
+        // length of the sequence from the leading byte (110xxxxx, 1110xxxx, 11110xxx)
+        const size_t  len       = ((c & 0xE0) == 0xC0) ? 2 : ((c & 0xF0) == 0xE0) ? 3 : ((c & 0xF8) == 0xF0) ? 4 : 0;
+        std::uint32_t codepoint = c & (0x7F >> len);
+
+        // invalid UTF-8 sequence, count the byte as a single cell like most terminals do
+        size_t j = 1;
+        for (; len > 0 && j < len && i + j < str.length() && (str[i + j] & 0xC0) == 0x80; ++j)
+            codepoint = (codepoint << 6) | (str[i + j] & 0x3F);
+        if (len == 0 || j != len)
+        {
+            ++width;
+            ++i;
+            continue;
+        }
+
+        width += get_codepoint_width(codepoint);
+        i += len;
+    }
+
+    return width;
+}
+
 std::string expandVar(std::string ret, bool dont)
 {
     if (ret.empty() || dont)
@@ -357,6 +422,8 @@ void replace_str(std::string& str, const std::string_view from, const std::strin
 bool read_exec(std::vector<std::string> cmd, std::string& output, bool useStdErr, bool noerror_print)
 {
     debug("{} cmd = {}", __func__, cmd);
+    if (Profile::record_spawn)
+        Profile::record_spawn(cmd.front());
     TinyProcessLib::Process proc(
         cmd, "",
         [&](const char* bytes, size_t n) {
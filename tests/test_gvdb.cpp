@@ -0,0 +1,123 @@
+/*
+ * Copyright 2025 Toni500git
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "core-modules/linux/utils/gvdb.hh"
+
+#include "catch2/catch_amalgamated.hpp"
+
+struct test_item_t
+{
+    std::string   full_key;  // for the hash
+    std::string   key;       // the last part stored in the item
+    std::uint32_t parent;
+    char          type;
+    std::string   value;
+};
+
+static void put_u32(std::string& buf, const size_t offset, const std::uint32_t n)
+{ std::memcpy(&buf[offset], &n, sizeof(n)); }
+
+// A GVDB file with a single hash table of one bucket, in the host byte order
+static std::string make_gvdb(const std::vector<test_item_t>& items)
+{
+    const std::uint32_t root_start = 24;
+    const std::uint32_t items_start = root_start + 8 + 4;
+    const std::uint32_t root_end = items_start + items.size() * 24;
+
+    std::string buf(root_end, '\0');
+    buf.replace(0, 8, "GVariant");
+    put_u32(buf, 16, root_start);
+    put_u32(buf, 20, root_end);
+    put_u32(buf, root_start, 0);      // no bloom filter
+    put_u32(buf, root_start + 4, 1);  // one bucket, starting at the first item
+
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        std::uint32_t hash = 5381;
+        for (const char c : items[i].full_key)
+            hash = (hash * 33) + static_cast<signed char>(c);
+
+        const std::uint32_t off = items_start + i * 24;
+        put_u32(buf, off, hash);
+        put_u32(buf, off + 4, items[i].parent);
+        put_u32(buf, off + 8, buf.size());
+        const std::uint16_t key_size = items[i].key.size();
+        std::memcpy(&buf[off + 12], &key_size, sizeof(key_size));
+        buf[off + 14] = items[i].type;
+        buf += items[i].key;
+
+        put_u32(buf, off + 16, buf.size());
+        buf += items[i].value;
+        put_u32(buf, off + 20, buf.size());
+    }
+
+    return buf;
+}
+
+TEST_CASE( "gvdb.cc test suitcase", "[Gvdb]" ) {
+    const std::filesystem::path& path = std::filesystem::temp_directory_path() / "customfetch-test-gvdb";
+    const std::int32_t number = -42;
+    std::string number_value(reinterpret_cast<const char*>(&number), sizeof(number));
+    number_value += std::string("\0i", 2);
+
+    std::ofstream(path, std::ios::binary) << make_gvdb({
+        { "/org/", "/org/", 0xffffffff, 'L', "" },
+        { "/org/gtk-theme", "gtk-theme", 0, 'v', std::string("Adwaita\0\0s", 10) },
+        { "/org/animations", "animations", 0, 'v', std::string("\1\0b", 3) },
+        { "/org/size", "size", 0, 'v', number_value },
+        { "/org/broken", "broken", 0, 'v', std::string("no type", 7) },
+    });
+
+    SECTION( "Lookups" ) {
+        std::vector<std::string> values{ "", "", "", "", "default" };
+        REQUIRE(gvdb_read_keys(path.string(), { "/org/gtk-theme", "/org/animations", "/org/size", "/org/broken", "/org/missing" }, values));
+        REQUIRE(values == std::vector<std::string>{ "Adwaita", "true", "-42", "", "default" });
+    }
+
+    SECTION( "Keys are matched with their parents" ) {
+        std::vector<std::string> values;
+        REQUIRE(gvdb_read_keys(path.string(), { "/com/gtk-theme", "gtk-theme", "/org/" }, values));
+        REQUIRE(values == std::vector<std::string>{ "", "", "" });
+    }
+
+    SECTION( "Invalid files" ) {
+        std::vector<std::string> values;
+        REQUIRE_FALSE(gvdb_read_keys("/nonexistent/customfetch-gvdb", { "/org/gtk-theme" }, values));
+
+        std::ofstream(path, std::ios::binary) << "GVariant but too short";
+        REQUIRE_FALSE(gvdb_read_keys(path.string(), { "/org/gtk-theme" }, values));
+
+        std::ofstream(path, std::ios::binary) << std::string(64, 'x');
+        REQUIRE_FALSE(gvdb_read_keys(path.string(), { "/org/gtk-theme" }, values));
+    }
+
+    std::filesystem::remove(path);
+}
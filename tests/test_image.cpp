@@ -0,0 +1,71 @@
+/*
+ * Copyright 2025 Toni500git
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS” AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include "image.hpp"
+#include "util.hpp"
+
+#include "catch2/catch_amalgamated.hpp"
+
+static std::filesystem::path write_file(const std::string& name, const std::string& content)
+{
+    const std::filesystem::path& path = std::filesystem::temp_directory_path() / ("customfetch-test-" + name);
+    std::ofstream(path, std::ios::binary) << content;
+    return path;
+}
+
+// the iterm2 protocol sends the file as it is, base64 encoded
+static std::string iterm2_base64(const std::string& name, const std::string& content)
+{
+    const std::filesystem::path& path = write_file(name, content);
+    const std::string& ret = Image::encode(path, "iterm2", 1, 1, 10, 20);
+    std::filesystem::remove(path);
+
+    const size_t start = ret.find("preserveAspectRatio=1:") + "preserveAspectRatio=1:"_len;
+    return ret.substr(start, ret.find('\a', start) - start);
+}
+
+TEST_CASE( "image.cpp test suitcase", "[Image]" ) {
+    SECTION( "Base64" ) {
+        REQUIRE(iterm2_base64("b64-0", "") == "");
+        REQUIRE(iterm2_base64("b64-1", "M") == "TQ==");
+        REQUIRE(iterm2_base64("b64-2", "Ma") == "TWE=");
+        REQUIRE(iterm2_base64("b64-3", "Man") == "TWFu");
+        REQUIRE(iterm2_base64("b64-bin", std::string("\xff\x00\xfe\x01", 4)) == "/wD+AQ==");
+    }
+
+    SECTION( "Sixel run-length encoding" ) {
+        // a single red pixel, scaled to the cells. Bands are 6 pixels high, so every column is '~',
+        // and red is the color 180 of the 6x6x6 cube
+        const std::filesystem::path& path = write_file("red.ppm", std::string("P6 1 1 255\n\xff\x00\x00", 14));
+        const std::string& header = "\0337\033P0;1;0q\"1;1;";
+        REQUIRE(Image::encode(path, "sixel", 1, 1, 3, 6) == header + "3;6#180;2;100;0;0#180~~~$-\033\\\0338");
+        REQUIRE(Image::encode(path, "sixel", 1, 1, 4, 6) == header + "4;6#180;2;100;0;0#180!4~$-\033\\\0338");
+        REQUIRE(Image::encode(path, "sixel", 1, 1, 12, 6) == header + "12;6#180;2;100;0;0#180!12~$-\033\\\0338");
+        std::filesystem::remove(path);
+    }
+}
@@ -32,20 +32,39 @@ std::string tmp;
 TEST_CASE( "util.cpp test suitcase", "[Util]" ) {
     SECTION( "String asserts" ) {
         std::string strip_str{"   strip_\tthis_\nstring"};
-        strip(strip_str);
+        strip(strip_str, false);
         std::string replace_str_str{"replace foo and foo with bar"};
         replace_str(replace_str_str, "foo", "bar");
         std::string env = std::getenv("HOME");
         std::string path = "~/.config/customfetch";
+        std::string exec_output;
 
         REQUIRE(hasEnding("I want the end", "end"));
         REQUIRE(hasStart("And now the begin, then  I want the end", "And"));
         REQUIRE(expandVar(path) == env + "/.config/customfetch");
-        REQUIRE(read_shell_exec("echo hello") == "hello");
+        REQUIRE(read_exec({"printf", "hello"}, exec_output));
+        REQUIRE(exec_output == "hello");
         REQUIRE(split("this;should;be;a;vector", ';') == std::vector<std::string>{"this", "should", "be", "a", "vector"});
         REQUIRE(strip_str == "strip_this_string");
         REQUIRE(replace_str_str == "replace bar and bar with bar");
         REQUIRE(str_tolower("ThIS SHouLD Be LOWER") == "this should be lower");
         REQUIRE(str_toupper("ThIS SHouLD Be UPPER") == "THIS SHOULD BE UPPER");
     }
+
+    SECTION( "Display width" ) {
+        REQUIRE(get_display_width("") == 0);
+        REQUIRE(get_display_width("hello") == 5);
+        REQUIRE(get_display_width("e\u0301") == 1);            // e + combining acute accent
+        REQUIRE(get_display_width("\u4f60\u597d") == 4);       // CJK
+        REQUIRE(get_display_width("\U0001f600 ok") == 5);      // emoji
+        REQUIRE(get_display_width("\xff\xfe") == 2);           // invalid UTF-8, one cell per byte
+        REQUIRE(get_display_width("\xe4\xbd") == 2);           // truncated sequence
+
+        // the ASCII fast path reads 8 bytes at a time, put the wide character across and after that
+        REQUIRE(get_display_width("1234567\u4f60") == 9);
+        REQUIRE(get_display_width("123456\u4f60ab") == 10);
+        REQUIRE(get_display_width("12345678\u4f60") == 10);
+        REQUIRE(get_display_width("1234567812345678") == 16);
+        REQUIRE(get_display_width("12345678123456781e\u0301") == 18);
+    }
 }